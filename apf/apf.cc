@@ -321,6 +321,11 @@ double getDV(MeshElement* e, Vector3 const& param)
   return e->getDV(param);
 }
 
+double getDV(MeshElement* e, int order, int point)
+{
+  return e->getDV(order, point);
+}
+
 int getOrder(MeshElement* e)
 {
   return e->getOrder();
@@ -404,6 +409,18 @@ void getShapeGrads(Element* e, Vector3 const& local,
   e->getGlobalGradients(local,grads);
 }
 
+void getShapeValues(Element* e, int order, int point,
+    NewArray<double>& values)
+{
+  e->getShapeValues(order,point,values);
+}
+
+void getShapeGrads(Element* e, int order, int point,
+    NewArray<Vector3>& grads)
+{
+  e->getGlobalGradients(order,point,grads);
+}
+
 FieldShape* getShape(Field* f)
 {
   return f->getShape();
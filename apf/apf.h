@@ -400,6 +400,13 @@ void mapLocalToGlobal(MeshElement* e, Vector3 const& local, Vector3& global);
   */
 double getDV(MeshElement* e, Vector3 const& param);
 
+/** \brief Get the differential volume at an integration point.
+  *
+  * \details the same as getDV at the point given by apf::getIntPoint,
+  * using tabulated shape functions for the coordinate field.
+  */
+double getDV(MeshElement* e, int order, int point);
+
 /** \brief A virtual base for user-defined integrators.
   *
   * \details Users of APF can define an Integrator object to handle
@@ -581,6 +588,23 @@ void getShapeValues(Element* e, Vector3 const& local,
 void getShapeGrads(Element* e, Vector3 const& local,
     NewArray<Vector3>& grads);
 
+/** \brief Returns the shape function values at an integration point
+  *
+  * \details the same as getShapeValues at the point given by
+  * apf::getIntPoint, but shapes that do not depend on the element
+  * are looked up in a table built once per element type and order.
+  */
+void getShapeValues(Element* e, int order, int point,
+    NewArray<double>& values);
+
+/** \brief Returns the shape function gradients at an integration point
+  *
+  * \details the tabulated form of getShapeGrads, see the
+  * integration point form of apf::getShapeValues.
+  */
+void getShapeGrads(Element* e, int order, int point,
+    NewArray<Vector3>& grads);
+
 
 /** \brief Retrieve the apf::FieldShape used by a field
   */
@@ -644,6 +668,41 @@ void writeASCIIVtkFiles(const char* prefix, Mesh* m);
 void writeASCIIVtkFiles(const char* prefix, Mesh* m,
     std::vector<std::string> writeFields);
 
+/** \brief Write a set of parallel VTK Unstructured Mesh files from an apf::Mesh
+  * with the arrays appended as raw binary data
+  * \details Only fields whose name appears in the vector writeFields will be
+  * output, with the same rules as apf::writeVtkFiles.
+  * Instead of base64 text, each part writes the bytes of its arrays after
+  * the XML of its piece with a few large writes, and rank zero reports
+  * the bytes per second written by the parts.
+  * \param compression the zlib level of the compressed blocks, from 1
+  * (fastest) to 9 (smallest). Zero, or a build without LION_COMPRESS,
+  * writes uncompressed arrays.
+  * \param writeFloat32 write the coordinates and double fields as Float32
+  */
+void writeRawVtkFiles(const char* prefix, Mesh* m,
+    std::vector<std::string> writeFields, int compression = 0,
+    bool writeFloat32 = false, int cellDim = -1);
+
+/** \brief Write all complete fields with apf::writeRawVtkFiles */
+void writeRawVtkFiles(const char* prefix, Mesh* m, int compression = 0,
+    bool writeFloat32 = false, int cellDim = -1);
+
+/** \brief Write one VTKHDF UnstructuredGrid file from an apf::Mesh
+  * \details All parts write their piece into the file (prefix).vtkhdf
+  * through HDF5, collectively when HDF5 supports MPI-IO and in turns
+  * otherwise. Taking turns costs one barrier and file open per part
+  * and is meant for small runs, so at scale build against a parallel
+  * HDF5. Only fields whose name appears in the vector writeFields
+  * will be output, with the same rules as apf::writeVtkFiles.
+  * This requires building with APF_VTKHDF.
+  */
+void writeVtkHdfFiles(const char* prefix, Mesh* m,
+    std::vector<std::string> writeFields, int cellDim = -1);
+
+/** \brief Write all complete fields with apf::writeVtkHdfFiles */
+void writeVtkHdfFiles(const char* prefix, Mesh* m, int cellDim = -1);
+
 /** \brief Return the location of a gaussian integration point.
   \param type the element type, from apf::Mesh::getType
   \param order the order of the integration rule
@@ -9,6 +9,8 @@
 #include "apfCavityOp.h"
 #include "apf.h"
 #include "apfMesh2.h"
+#include <algorithm>
+#include <functional>
 
 namespace apf {
 
@@ -18,6 +20,8 @@ CavityOp::CavityOp(Mesh* m, bool cm):
   canModify(cm),
   movedByDeletion(false),
   iterator(0),
+  pullRounds(0),
+  pulledElements(0),
   sharing(0)
 {
 }
@@ -101,6 +105,8 @@ void CavityOp::applyToDimension(int d)
    * constant number of iterations that does not grow
    * with parallelism
    */
+  pullRounds = 0;
+  pulledElements = 0;
   do {
     delete sharing;
     sharing = apf::getSharing(mesh);
@@ -127,8 +133,7 @@ bool CavityOp::requestLocality(MeshEntity** entities, int count)
     if (sharing->isShared(entities[i]))
       areLocal = false;
   if (isRequesting && ( ! areLocal))
-    for (int i=0; i < count; ++i)
-      requests.insert(requests.end(),entities,entities+count);
+    requests.insert(requests.end(),entities,entities+count);
   return areLocal;
 }
 
@@ -136,6 +141,9 @@ bool CavityOp::sendPullRequests(std::vector<PullRequest>& received)
 {
   int done = PCU_Min_Int(requests.empty());
   if (done) return false;
+  /* cavities that overlap request the same entities */
+  std::sort(requests.begin(),requests.end());
+  requests.erase(std::unique(requests.begin(),requests.end()),requests.end());
   /* throw in the local pull requests */
   int self = PCU_Comm_Self();
   received.reserve(requests.size());
@@ -186,6 +194,9 @@ bool CavityOp::sendPullRequests(std::vector<PullRequest>& received)
    Other databases may use MIN part ID as their ownership rule,
    which is why this one is MAX (just in case) */
 
+static int totalPullRounds = 0;
+static long totalPulledElements = 0;
+
 static int ownership(int a, int b)
 {
   return std::max(a,b);
@@ -222,11 +233,40 @@ bool CavityOp::tryToPull()
   std::vector<PullRequest> pulls;
   if ( ! sendPullRequests(pulls))
     return false;
+  /* an entity may be pulled by several parts. since the
+     highest of them wins every element around it, sorting
+     the requests lets its elements be found only once */
+  struct HighestFirst
+  {
+    bool operator()(PullRequest const& a, PullRequest const& b) const
+    {
+      if (a.e != b.e)
+        return std::less<MeshEntity*>()(a.e,b.e);
+      return a.to > b.to;
+    }
+  };
+  std::sort(pulls.begin(),pulls.end(),HighestFirst());
   Migration* plan = new Migration(mesh);
   for (std::size_t i=0; i < pulls.size(); ++i)
-    markElements(plan,pulls[i].e,pulls[i].to);
+    if (( ! i)||(pulls[i].e != pulls[i - 1].e))
+      markElements(plan,pulls[i].e,pulls[i].to);
+  int self = PCU_Comm_Self();
+  long sent = 0;
+  for (int i=0; i < plan->count(); ++i)
+    if (plan->sending(plan->get(i)) != self)
+      ++sent;
+  ++pullRounds;
+  pulledElements += sent;
+  ++totalPullRounds;
+  totalPulledElements += sent;
   mesh->migrate(plan); //plan deleted here
   return true;
 }
 
+void getCavityPulls(int& rounds, long& elements)
+{
+  rounds = totalPullRounds;
+  elements = totalPulledElements;
+}
+
 } //namespace apf
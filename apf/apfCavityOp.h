@@ -91,6 +91,10 @@ class CavityOp
     bool requestLocality(MeshEntity** entities, int count);
     /** \brief call before deleting a mesh entity during the operation */
     void preDeletion(MeshEntity* e);
+    /** \brief migrations done by the last applyToDimension */
+    int getPullRounds() {return pullRounds;}
+    /** \brief elements those migrations sent to other parts */
+    long getPulledElements() {return pulledElements;}
     /** \brief mesh pointer for convenience */
     Mesh* mesh;
   private:
@@ -105,10 +109,19 @@ class CavityOp
     bool canModify;
     bool movedByDeletion;
     MeshIterator* iterator;
+    int pullRounds;
+    long pulledElements;
   protected:
     Sharing* sharing;
 };
 
+/** \brief read the migrations done by CavityOp pull requests
+  \details these count up over the life of the process:
+  rounds is the number of pull migrations and elements the
+  number of elements they sent to other parts.
+  compare two readings to profile an operation. */
+void getCavityPulls(int& rounds, long& elements);
+
 } //namespace apf
 
 #endif
@@ -9,6 +9,8 @@
 #include "apfShape.h"
 #include "apfMesh.h"
 #include "apfVectorElement.h"
+#include "apfShapeTable.h"
+#include "apfIntegrate.h"
 
 namespace apf {
 
@@ -85,6 +87,39 @@ void Element::getGlobalGradients(Vector3 const& local,
     globalGradients[i] = jinv * localGradients[i];
 }
 
+Vector3 Element::getIntPoint(int order, int point)
+{
+  return getIntegration(getType())->getAccurate(order)->getPoint(point)->param;
+}
+
+/* the same as above at an integration point, using the
+   tabulated shape functions when there are some */
+void Element::getGlobalGradients(int order, int point,
+                                 NewArray<Vector3>& globalGradients)
+{
+  ShapeTable const* t = getShapeTable(field->getShape(), getType(), order);
+  if (!t)
+    return getGlobalGradients(getIntPoint(order, point), globalGradients);
+  Matrix3x3 J;
+  parent->getJacobian(order, point, J);
+  Matrix3x3 jinv = getJacobianInverse(J, getDimension());
+  Vector3 const* localGradients = t->getLocalGradients(point);
+  globalGradients.allocate(nen);
+  for (int i=0; i < nen; ++i)
+    globalGradients[i] = jinv * localGradients[i];
+}
+
+void Element::getShapeValues(int order, int point, NewArray<double>& values)
+{
+  ShapeTable const* t = getShapeTable(field->getShape(), getType(), order);
+  if (!t)
+    return shape->getValues(mesh, entity, getIntPoint(order, point), values);
+  double const* v = t->getValues(point);
+  values.allocate(nen);
+  for (int i=0; i < nen; ++i)
+    values[i] = v[i];
+}
+
 void Element::getComponents(Vector3 const& xi, double* c)
 {
   NewArray<double> shapeValues;
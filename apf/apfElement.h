@@ -25,6 +25,9 @@ class Element
     virtual ~Element();
     void getGlobalGradients(Vector3 const& local,
                             NewArray<Vector3>& globalGradients);
+    void getGlobalGradients(int order, int point,
+                            NewArray<Vector3>& globalGradients);
+    void getShapeValues(int order, int point, NewArray<double>& values);
     int getType() {return mesh->getType(entity);}
     int getDimension() {return Mesh::typeDimension[getType()];}
     int getOrder() {return field->getShape()->getOrder();}
@@ -33,6 +36,7 @@ class Element
     Mesh* getMesh() {return mesh;}
     EntityShape* getShape() {return shape;}
     void getComponents(Vector3 const& xi, double* c);
+    Vector3 getIntPoint(int order, int point);
   protected:
     void init(Field* f, MeshEntity* e, VectorElement* p);
     void getNodeData();
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfElementBatch.h"
+#include "apfField.h"
+#include "apfFieldData.h"
+#include "apfShape.h"
+#include "apfMesh.h"
+#include "apfIntegrate.h"
+#include "apfShapeTable.h"
+#include <pcu_util.h>
+#include <cmath>
+
+namespace apf {
+
+ElementBatch::ElementBatch(Mesh* m, int t, int o, int c):
+  mesh(m),
+  type(t),
+  dimension(Mesh::typeDimension[t]),
+  order(o),
+  capacity(c),
+  size(0)
+{
+  PCU_ALWAYS_ASSERT(capacity > 0);
+  Integration const* integration = getIntegration(type)->getAccurate(order);
+  if (!integration)
+    fail("ElementBatch: no integration of this order for this type\n");
+  points = integration->countPoints();
+  xi.resize(points);
+  weights.resize(points);
+  for (int p = 0; p < points; ++p) {
+    IntegrationPoint const* ip = integration->getPoint(p);
+    xi[p] = ip->param;
+    weights[p] = ip->weight;
+  }
+  elements.resize(capacity);
+  jacobians.assign(points * 9 * capacity, 0);
+  dv.resize(points * capacity);
+}
+
+ElementBatch::~ElementBatch()
+{
+}
+
+void ElementBatch::gatherNodes(Field* f, int nc, std::vector<double>& out)
+{
+  FieldDataOf<double>* data = f->getData();
+  int nen = f->getShape()->getEntityShape(type)->countNodes();
+  size_t needed = nen * nc * capacity;
+  if (out.size() < needed)
+    out.resize(needed);
+  for (int i = 0; i < size; ++i) {
+    data->getElementData(elements[i], elementData);
+    for (int k = 0; k < nen; ++k)
+      for (int c = 0; c < nc; ++c)
+        out[(k * nc + c) * capacity + i] = elementData[k * nc + c];
+  }
+}
+
+void ElementBatch::gather(MeshEntity* const* e, int n)
+{
+  PCU_ALWAYS_ASSERT(n <= capacity);
+  size = n;
+  for (int i = 0; i < n; ++i)
+    elements[i] = e[i];
+  if (!n)
+    return;
+  gatherNodes(mesh->getCoordinateField(), 3, coordinates);
+  computeJacobians();
+  computeDVs();
+}
+
+/* J[a][b] is the sum over nodes of dN_k/dxi_a times x_k[b],
+   the same as apf::VectorElement::getJacobian */
+void ElementBatch::computeJacobians()
+{
+  FieldShape* s = mesh->getShape();
+  EntityShape* es = s->getEntityShape(type);
+  ShapeTable const* t = getShapeTable(s, type, order);
+  int nen = es->countNodes();
+  if (!t) {
+    for (int i = 0; i < size; ++i)
+      for (int p = 0; p < points; ++p) {
+        es->getLocalGradients(mesh, elements[i], xi[p], shapeGradients);
+        for (int a = 0; a < dimension; ++a)
+          for (int b = 0; b < 3; ++b) {
+            double sum = 0;
+            for (int k = 0; k < nen; ++k)
+              sum += shapeGradients[k][a] *
+                     coordinates[(k * 3 + b) * capacity + i];
+            jacobians[((p * 3 + a) * 3 + b) * capacity + i] = sum;
+          }
+      }
+    return;
+  }
+  for (int p = 0; p < points; ++p)
+    for (int a = 0; a < dimension; ++a)
+      for (int b = 0; b < 3; ++b) {
+        double* J = &jacobians[((p * 3 + a) * 3 + b) * capacity];
+        for (int i = 0; i < size; ++i)
+          J[i] = 0;
+        for (int k = 0; k < nen; ++k) {
+          double g = t->getLocalGradients(p)[k][a];
+          double const* x = &coordinates[(k * 3 + b) * capacity];
+          for (int i = 0; i < size; ++i)
+            J[i] += g * x[i];
+        }
+      }
+}
+
+/* the same as apf::getJacobianDeterminant, one point at a time */
+void ElementBatch::computeDVs()
+{
+  for (int p = 0; p < points; ++p) {
+    double const* J[3][3];
+    for (int a = 0; a < 3; ++a)
+      for (int b = 0; b < 3; ++b)
+        J[a][b] = &jacobians[((p * 3 + a) * 3 + b) * capacity];
+    double* v = &dv[p * capacity];
+    if (dimension == 3) {
+      for (int i = 0; i < size; ++i)
+        v[i] = J[0][0][i] * (J[1][1][i] * J[2][2][i] - J[1][2][i] * J[2][1][i])
+             - J[0][1][i] * (J[1][0][i] * J[2][2][i] - J[1][2][i] * J[2][0][i])
+             + J[0][2][i] * (J[1][0][i] * J[2][1][i] - J[1][1][i] * J[2][0][i]);
+    } else if (dimension == 2) {
+      for (int i = 0; i < size; ++i) {
+        double c0 = J[0][1][i] * J[1][2][i] - J[0][2][i] * J[1][1][i];
+        double c1 = J[0][2][i] * J[1][0][i] - J[0][0][i] * J[1][2][i];
+        double c2 = J[0][0][i] * J[1][1][i] - J[0][1][i] * J[1][0][i];
+        v[i] = std::sqrt(c0 * c0 + c1 * c1 + c2 * c2);
+      }
+    } else if (dimension == 1) {
+      for (int i = 0; i < size; ++i)
+        v[i] = std::sqrt(J[0][0][i] * J[0][0][i] +
+                         J[0][1][i] * J[0][1][i] +
+                         J[0][2][i] * J[0][2][i]);
+    } else {
+      for (int i = 0; i < size; ++i)
+        v[i] = 1;
+    }
+  }
+}
+
+Matrix3x3 ElementBatch::getJacobian(int i, int p) const
+{
+  Matrix3x3 J;
+  for (int a = 0; a < 3; ++a)
+    for (int b = 0; b < 3; ++b)
+      J[a][b] = jacobians[((p * 3 + a) * 3 + b) * capacity + i];
+  return J;
+}
+
+void ElementBatch::interpolate(Field* f, double* values)
+{
+  if (!size)
+    return;
+  int nc = f->countComponents();
+  gatherNodes(f, nc, nodeValues);
+  FieldShape* s = f->getShape();
+  EntityShape* es = s->getEntityShape(type);
+  ShapeTable const* t = getShapeTable(s, type, order);
+  int nen = es->countNodes();
+  int n = size;
+  if (!t) {
+    for (int i = 0; i < n; ++i)
+      for (int p = 0; p < points; ++p) {
+        es->getValues(mesh, elements[i], xi[p], shapeValues);
+        for (int c = 0; c < nc; ++c) {
+          double sum = 0;
+          for (int k = 0; k < nen; ++k)
+            sum += shapeValues[k] * nodeValues[(k * nc + c) * capacity + i];
+          values[(p * nc + c) * n + i] = sum;
+        }
+      }
+    return;
+  }
+  for (int p = 0; p < points; ++p)
+    for (int c = 0; c < nc; ++c) {
+      double* v = &values[(p * nc + c) * n];
+      for (int i = 0; i < n; ++i)
+        v[i] = 0;
+      for (int k = 0; k < nen; ++k) {
+        double N = t->getValues(p)[k];
+        double const* u = &nodeValues[(k * nc + c) * capacity];
+        for (int i = 0; i < n; ++i)
+          v[i] += N * u[i];
+      }
+    }
+}
+
+BatchIntegrator::BatchIntegrator(int o, int c):
+  order(o),
+  capacity(c)
+{
+}
+
+BatchIntegrator::~BatchIntegrator()
+{
+}
+
+void BatchIntegrator::parallelReduce()
+{
+}
+
+void BatchIntegrator::process(Mesh* m, int d)
+{
+  if (d < 0)
+    d = m->getDimension();
+  PCU_DEBUG_ASSERT(d <= m->getDimension());
+  ElementBatch* batches[Mesh::TYPES] = {};
+  std::vector<MeshEntity*> pending[Mesh::TYPES];
+  MeshEntity* e;
+  MeshIterator* it = m->begin(d);
+  while ((e = m->iterate(it))) {
+    if (!m->isOwned(e))
+      continue;
+    int t = m->getType(e);
+    std::vector<MeshEntity*>& p = pending[t];
+    if (!batches[t]) {
+      batches[t] = new ElementBatch(m, t, order, capacity);
+      p.reserve(capacity);
+    }
+    p.push_back(e);
+    if (static_cast<int>(p.size()) == capacity) {
+      batches[t]->gather(&p[0], capacity);
+      this->inBatch(*(batches[t]));
+      p.clear();
+    }
+  }
+  m->end(it);
+  for (int t = 0; t < Mesh::TYPES; ++t) {
+    if (!batches[t])
+      continue;
+    if (!pending[t].empty()) {
+      batches[t]->gather(&pending[t][0], pending[t].size());
+      this->inBatch(*(batches[t]));
+    }
+    delete batches[t];
+  }
+  this->parallelReduce();
+}
+
+}
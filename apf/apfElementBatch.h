@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_ELEMENT_BATCH_H
+#define APF_ELEMENT_BATCH_H
+
+/** \file apfElementBatch.h
+  \brief evaluation of fields over batches of elements */
+
+#include "apfMatrix.h"
+#include "apfNew.h"
+#include <vector>
+
+namespace apf {
+
+class Mesh;
+class MeshEntity;
+class Field;
+class FieldShape;
+
+/** \brief evaluates a group of elements of one type together
+  \details apf::Element and apf::Integrator evaluate shape functions
+  and Jacobians one point of one element at a time, through
+  virtual calls and temporary arrays.
+  An ElementBatch instead gathers the coordinates of up to
+  (capacity) elements of one type into contiguous arrays,
+  with the element index varying fastest.
+  It takes the shape functions at the integration points from
+  apf::getShapeTable, and computes the Jacobians,
+  differential volumes and field values of the whole batch in
+  loops over the elements.
+  A batch allocates nothing after its first use with each field.
+
+  Shapes whose values depend on the element
+  (apf::FieldShape::dependsOnEntity) are evaluated for each
+  element, so batches still work for them, only more slowly. */
+class ElementBatch
+{
+  public:
+    /** \brief make a batch for elements of (type)
+      \param order the order of accuracy of the integration points */
+    ElementBatch(Mesh* m, int type, int order, int capacity = 64);
+    ~ElementBatch();
+    /** \brief gather (n) elements, at most the capacity,
+      and compute their Jacobians and differential volumes */
+    void gather(MeshEntity* const* elements, int n);
+    int countElements() const {return size;}
+    int getCapacity() const {return capacity;}
+    MeshEntity* getElement(int i) const {return elements[i];}
+    int getType() const {return type;}
+    int getDimension() const {return dimension;}
+    int countPoints() const {return points;}
+    /** \brief parent coordinates of an integration point */
+    Vector3 const& getPoint(int p) const {return xi[p];}
+    double getWeight(int p) const {return weights[p];}
+    /** \brief the Jacobian at point (p) of element (i) */
+    Matrix3x3 getJacobian(int i, int p) const;
+    /** \brief the differential volumes at point (p)
+      \details element (i) has its value at index (i) */
+    double const* getDVs(int p) const {return &dv[p * capacity];}
+    /** \brief interpolate a field at all the points of all elements
+      \details component (c) of the value at point (p) of element
+      (i) is written to values[(p * nc + c) * n + i], where (nc) is
+      the number of field components and (n) that of elements. */
+    void interpolate(Field* f, double* values);
+  private:
+    ElementBatch(ElementBatch const&);
+    ElementBatch& operator=(ElementBatch const&);
+    void gatherNodes(Field* f, int nc, std::vector<double>& out);
+    void computeJacobians();
+    void computeDVs();
+    Mesh* mesh;
+    int type;
+    int dimension;
+    int order;
+    int capacity;
+    int size;
+    int points;
+    std::vector<Vector3> xi;
+    std::vector<double> weights;
+    std::vector<MeshEntity*> elements;
+    /* coordinates[(k * 3 + d) * capacity + i] */
+    std::vector<double> coordinates;
+    /* nodeValues[(k * nc + c) * capacity + i] */
+    std::vector<double> nodeValues;
+    /* jacobians[((p * 3 + a) * 3 + b) * capacity + i] */
+    std::vector<double> jacobians;
+    /* dv[p * capacity + i] */
+    std::vector<double> dv;
+    NewArray<double> elementData;
+    NewArray<double> shapeValues;
+    NewArray<Vector3> shapeGradients;
+};
+
+/** \brief an integrator that is given batches of elements
+  \details this is the batched form of apf::Integrator.
+  The owned elements of each type are put in batches of up to
+  (capacity) elements, and inBatch is called for each. */
+class BatchIntegrator
+{
+  public:
+    BatchIntegrator(int order, int capacity = 64);
+    virtual ~BatchIntegrator();
+    /** \brief run over the owned elements of one dimension
+      \param dim the dimension, by default the mesh dimension */
+    void process(Mesh* m, int dim = -1);
+    /** \brief user callback for every batch of elements */
+    virtual void inBatch(ElementBatch& batch) = 0;
+    /** \brief user callback once all batches are done,
+      for reducing results over all parts */
+    virtual void parallelReduce();
+  protected:
+    int order;
+    int capacity;
+};
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apfExchange.h"
+#include "apfField.h"
+#include "apfFieldData.h"
+#include "apfShape.h"
+#include "apfMesh.h"
+#include <pcu_util.h>
+
+namespace apf {
+
+Exchange::Exchange(Mesh* m, Sharing* shr)
+{
+  mesh = m;
+  sharing = shr;
+  ownsSharing = false;
+  if (!sharing) {
+    sharing = getSharing(m);
+    ownsSharing = true;
+  }
+  build(syncPlan, false);
+  build(reducePlan, true);
+}
+
+Exchange::~Exchange()
+{
+  if (ownsSharing)
+    delete sharing;
+}
+
+/* each part lists the copies it sends to, and tells every
+   copy where it falls in that list, so that later exchanges
+   carry only values in an order both sides agree on.
+   this follows what synchronizeFieldData and reduceFieldData
+   send, except that it does not depend on any field. */
+void Exchange::build(Plan& plan, bool reducing)
+{
+  PCU_Comm_Begin();
+  for (int d = 0; d < 4; ++d) {
+    MeshIterator* it = mesh->begin(d);
+    MeshEntity* e;
+    while ((e = mesh->iterate(it))) {
+      if (reducing && mesh->isGhost(e) && sharing->isShared(e)) {
+        neutral[d].push_back(e);
+        continue;
+      }
+      if ((!reducing) && (!sharing->isOwned(e)))
+        continue;
+      CopyArray copies;
+      sharing->getCopies(e, copies);
+      for (size_t i = 0; i < copies.getSize(); ++i) {
+        plan[copies[i].peer].send[d].push_back(e);
+        PCU_COMM_PACK(copies[i].peer, copies[i].entity);
+      }
+      if (reducing && (!copies.getSize()))
+        continue;
+      Copies ghosts;
+      if (mesh->getGhosts(e, ghosts))
+        APF_ITERATE(Copies, ghosts, git) {
+          plan[git->first].send[d].push_back(e);
+          PCU_COMM_PACK(git->first, git->second);
+        }
+    }
+    mesh->end(it);
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen()) {
+    Links& links = plan[PCU_Comm_Sender()];
+    while (!PCU_Comm_Unpacked()) {
+      MeshEntity* e;
+      PCU_COMM_UNPACK(e);
+      links.recv[getDimension(mesh, e)].push_back(e);
+    }
+  }
+}
+
+void Exchange::exchange(Plan& plan, Field** fields, int n,
+    ReductionOp<double> const* op)
+{
+  PCU_Comm_Begin();
+  std::vector<double> values;
+  APF_ITERATE(Plan, plan, pit) {
+    values.clear();
+    for (int i = 0; i < n; ++i) {
+      FieldDataOf<double>* data = fields[i]->getData();
+      FieldShape* s = fields[i]->getShape();
+      for (int d = 0; d < 4; ++d) {
+        if (!s->hasNodesIn(d))
+          continue;
+        std::vector<MeshEntity*> const& ents = pit->second.send[d];
+        for (size_t j = 0; j < ents.size(); ++j) {
+          int nv = fields[i]->countValuesOn(ents[j]);
+          if (!nv)
+            continue;
+          size_t at = values.size();
+          values.resize(at + nv, op ? op->getNeutralElement() : 0);
+          if (data->hasEntity(ents[j]))
+            data->get(ents[j], &values[at]);
+        }
+      }
+    }
+    if (values.size())
+      PCU_Comm_Pack(pit->first, &values[0], values.size() * sizeof(double));
+  }
+  PCU_Comm_Send();
+  NewArray<double> own;
+  while (PCU_Comm_Listen()) {
+    Plan::iterator pit = plan.find(PCU_Comm_Sender());
+    PCU_ALWAYS_ASSERT(pit != plan.end());
+    for (int i = 0; i < n; ++i) {
+      FieldDataOf<double>* data = fields[i]->getData();
+      FieldShape* s = fields[i]->getShape();
+      for (int d = 0; d < 4; ++d) {
+        if (!s->hasNodesIn(d))
+          continue;
+        std::vector<MeshEntity*> const& ents = pit->second.recv[d];
+        for (size_t j = 0; j < ents.size(); ++j) {
+          int nv = fields[i]->countValuesOn(ents[j]);
+          if (!nv)
+            continue;
+          double const* in = static_cast<double const*>(
+              PCU_Comm_Extract(nv * sizeof(double)));
+          if (!op) {
+            data->set(ents[j], in);
+            continue;
+          }
+          double* p = data->getEntityValues(ents[j]);
+          if (p) {
+            for (int k = 0; k < nv; ++k)
+              p[k] = op->apply(p[k], in[k]);
+            continue;
+          }
+          own.allocate(nv);
+          data->get(ents[j], &own[0]);
+          for (int k = 0; k < nv; ++k)
+            own[k] = op->apply(own[k], in[k]);
+          data->set(ents[j], &own[0]);
+        }
+      }
+    }
+    PCU_ALWAYS_ASSERT(PCU_Comm_Unpacked());
+  }
+}
+
+void Exchange::synchronize(Field* f)
+{
+  synchronize(&f, 1);
+}
+
+void Exchange::synchronize(Field** fields, int n)
+{
+  exchange(syncPlan, fields, n, 0);
+}
+
+void Exchange::accumulate(Field* f)
+{
+  accumulate(&f, 1);
+}
+
+void Exchange::accumulate(Field** fields, int n)
+{
+  reduce(fields, n, ReductionSum<double>());
+}
+
+void Exchange::reduce(Field** fields, int n, ReductionOp<double> const& op)
+{
+  /* ghosts of shared entities start from the neutral element,
+     as in reduceFieldData */
+  NewArray<double> values;
+  for (int i = 0; i < n; ++i) {
+    FieldDataOf<double>* data = fields[i]->getData();
+    for (int d = 0; d < 4; ++d)
+      for (size_t j = 0; j < neutral[d].size(); ++j) {
+        MeshEntity* e = neutral[d][j];
+        int nv = fields[i]->countValuesOn(e);
+        if ((!nv) || (!data->hasEntity(e)))
+          continue;
+        values.allocate(nv);
+        for (int k = 0; k < nv; ++k)
+          values[k] = op.getNeutralElement();
+        data->set(e, &values[0]);
+      }
+  }
+  exchange(reducePlan, fields, n, &op);
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_EXCHANGE_H
+#define APF_EXCHANGE_H
+
+/** \file apfExchange.h
+  \brief reusable communication plans for field synchronization */
+
+#include "apf.h"
+#include <map>
+
+namespace apf {
+
+class Mesh;
+class MeshEntity;
+class Field;
+struct Sharing;
+
+/** \brief a precomputed plan for exchanging field values between parts
+  \details apf::synchronize and apf::accumulate send a pointer to the
+  remote copy along with the values of every shared entity.
+  An Exchange instead agrees once with each neighboring part on
+  the order of the entities they share, after which every call
+  only gathers values into one contiguous buffer per neighbor and
+  scatters them on receipt.
+  Several fields can be exchanged in one communication phase.
+
+  The plan is only valid until the mesh or its partition changes.
+  Entities whose values were never set are sent as zeros when
+  synchronizing and as the neutral element when reducing. */
+class Exchange
+{
+  public:
+    /** \brief build the plan, collectively
+      \param shr the ownership and copies to use, or zero for
+                 the default apf::getSharing of the mesh.
+                 it must stay alive as long as the plan. */
+    Exchange(Mesh* m, Sharing* shr = 0);
+    ~Exchange();
+    /** \brief same as apf::synchronize */
+    void synchronize(Field* f);
+    /** \brief synchronize several fields in one phase */
+    void synchronize(Field** fields, int n);
+    /** \brief same as apf::accumulate */
+    void accumulate(Field* f);
+    /** \brief accumulate several fields in one phase */
+    void accumulate(Field** fields, int n);
+    /** \brief same as apf::sharedReduction, for several fields */
+    void reduce(Field** fields, int n, ReductionOp<double> const& op);
+  private:
+    Exchange(Exchange const&);
+    Exchange& operator=(Exchange const&);
+    struct Links
+    {
+      std::vector<MeshEntity*> send[4];
+      std::vector<MeshEntity*> recv[4];
+    };
+    typedef std::map<int, Links> Plan;
+    void build(Plan& plan, bool reducing);
+    void exchange(Plan& plan, Field** fields, int n,
+        ReductionOp<double> const* op);
+    Mesh* mesh;
+    Sharing* sharing;
+    bool ownsSharing;
+    Plan syncPlan;
+    Plan reducePlan;
+    std::vector<MeshEntity*> neutral[4];
+};
+
+}
+
+#endif
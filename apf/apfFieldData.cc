@@ -26,6 +26,7 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
     shr = getSharing(m);
     delete_shr=true;
   }
+  NewArray<T> values;
   for (int d=0; d < 4; ++d)
   {
     if ( ! s->hasNodesIn(d))
@@ -39,21 +40,26 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
           ( ! shr->isOwned(e)))
         continue;
       int n = f->countValuesOn(e);
-      NewArray<T> values(n);
-      data->get(e,&(values[0]));
+      T* p = data->getEntityValues(e);
+      if ( ! p)
+      {
+        values.allocate(n);
+        data->get(e,&(values[0]));
+        p = &(values[0]);
+      }
       CopyArray copies;
       shr->getCopies(e, copies);
       for (size_t i = 0; i < copies.getSize(); ++i)
       {
         PCU_COMM_PACK(copies[i].peer, copies[i].entity);
-        PCU_Comm_Pack(copies[i].peer, &(values[0]), n*sizeof(T));
+        PCU_Comm_Pack(copies[i].peer, p, n*sizeof(T));
       }
       apf::Copies ghosts;  
       if (m->getGhosts(e, ghosts))
       APF_ITERATE(Copies, ghosts, it)
       {
         PCU_COMM_PACK(it->first, it->second);
-        PCU_Comm_Pack(it->first, &(values[0]), n*sizeof(T));
+        PCU_Comm_Pack(it->first, p, n*sizeof(T));
       }
     }
     m->end(it);
@@ -63,7 +69,13 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
       MeshEntity* e;
       PCU_COMM_UNPACK(e);
       int n = f->countValuesOn(e);
-      NewArray<T> values(n);
+      T* p = data->getEntityValues(e);
+      if (p)
+      {
+        PCU_Comm_Unpack(p,n*sizeof(T));
+        continue;
+      }
+      values.allocate(n);
       PCU_Comm_Unpack(&(values[0]),n*sizeof(T));
       data->set(e,&(values[0]));
     }
@@ -161,6 +173,12 @@ void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, c
   if (delete_shr) delete shr;
 }
 
+template <class T>
+T* FieldDataOf<T>::getEntityValues(MeshEntity*)
+{
+  return 0;
+}
+
 template <class T>
 void FieldDataOf<T>::setNodeComponents(MeshEntity* e, int node,
     T const* components)
@@ -173,6 +191,12 @@ void FieldDataOf<T>::setNodeComponents(MeshEntity* e, int node,
   PCU_ALWAYS_ASSERT(node >= 0);
   PCU_ALWAYS_ASSERT(node < n);
   int nc = field->countComponents();
+  T* p = getEntityValues(e);
+  if (p) {
+    for (int i=0; i < nc; ++i)
+      p[node*nc+i] = components[i];
+    return;
+  }
   NewArray<T> allComponents(nc*n);
   if (this->hasEntity(e))
     get(e,&(allComponents[0]));
@@ -192,6 +216,12 @@ void FieldDataOf<T>::getNodeComponents(MeshEntity* e, int node, T* components)
   PCU_ALWAYS_ASSERT(node >= 0);
   PCU_ALWAYS_ASSERT(node < n);
   int nc = field->countComponents();
+  T* p = getEntityValues(e);
+  if (p) {
+    for (int i=0; i < nc; ++i)
+      components[i] = p[node*nc+i];
+    return;
+  }
   NewArray<T> allComponents(nc*n);
   get(e,&(allComponents[0]));
   for (int i=0; i < nc; ++i)
@@ -55,6 +55,13 @@ class FieldDataOf : public FieldData
     void setNodeComponents(MeshEntity* e, int node, T const* components);
     void getNodeComponents(MeshEntity* e, int node, T* components);
     int getElementData(MeshEntity* entity, NewArray<T>& data);
+    /** \brief the values of (e) where they are stored
+      \details storage that keeps the values of an entity
+      contiguous returns a pointer to them, valid until entities
+      are created, which can be read and written in place.
+      zero is returned if (e) has no values yet, and always by
+      the default, in which case get and set have to be used. */
+    virtual T* getEntityValues(MeshEntity* e);
     virtual FieldData* clone()=0;
 };
 
@@ -253,6 +253,7 @@ class HTetrahedron2 : public EntityShape {
 class Hierarchic2 : public FieldShape {
   public:
     const char* getName() const { return "Hierarchic2"; }
+    bool dependsOnEntity() { return false; }
     EntityShape* getEntityShape(int type) {
       static HVertex vtx;
       static HEdge2 edge;
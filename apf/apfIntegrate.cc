@@ -669,7 +669,7 @@ void Integrator::process(MeshElement* e)
     Vector3 point;
     getIntPoint(e,this->order,p,point);
     double w = getIntWeight(e,this->order,p);
-    double dV = getDV(e,point);
+    double dV = getDV(e,this->order,p);
     this->atPoint(point,w,dV);
   }
   this->outElement();
@@ -15,6 +15,7 @@
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include <algorithm>
+#include <vector>
 
 namespace apf {
 
@@ -156,6 +157,11 @@ Mesh::~Mesh()
   delete coordinateField;
 }
 
+MeshIterator* Mesh::beginRange(int, int, int)
+{
+  return 0;
+}
+
 int Mesh::getModelType(ModelEntity* e)
 {
   return gmi_dim(getModel(), (gmi_ent*)e);
@@ -191,6 +197,22 @@ void Mesh::snapToModel(ModelEntity* m, Vector3 const& p, Vector3& x)
   gmi_eval(getModel(), (gmi_ent*)m, &p[0], &x[0]);
 }
 
+void Mesh::snapToModel(int n, ModelEntity* const* g, Vector3 const* p,
+    Vector3* x)
+{
+  std::vector<double> params(n * 2);
+  std::vector<double> points(n * 3);
+  for (int i = 0; i < n; ++i) {
+    params[i * 2 + 0] = p[i][0];
+    params[i * 2 + 1] = p[i][1];
+  }
+  if (n)
+    gmi_eval_many(getModel(), n, (gmi_ent* const*)g,
+        (double const(*)[2])&params[0], (double(*)[3])&points[0]);
+  for (int i = 0; i < n; ++i)
+    x[i] = Vector3(&points[i * 3]);
+}
+
 void Mesh::getParamOn(ModelEntity* g, MeshEntity* e, Vector3& p)
 {
   ModelEntity* from_g = toModel(e);
@@ -396,6 +418,48 @@ void getPeers(Mesh* m, int d, Parts& peers)
   peers.erase(m->getId());
 }
 
+void declareNeighbors(Mesh* m)
+{
+  std::set<int> peers;
+  bool matched = m->hasMatching();
+  MeshEntity* e;
+  MeshIterator* it = m->begin(0);
+  while ((e = m->iterate(it))) {
+    if (m->isShared(e)) {
+      Copies remotes;
+      m->getRemotes(e, remotes);
+      APF_ITERATE(Copies, remotes, rit)
+        peers.insert(rit->first);
+    }
+    if (matched) {
+      Matches matches;
+      m->getMatches(e, matches);
+      for (size_t i = 0; i < matches.getSize(); ++i)
+        peers.insert(matches[i].peer);
+    }
+  }
+  m->end(it);
+  /* ghosts of any dimension exchange with their owners, which list
+     them in turn, so both sides see each other */
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      if (m->isGhost(e))
+        peers.insert(m->getOwner(e));
+      if (m->isGhosted(e)) {
+        Copies ghosts;
+        m->getGhosts(e, ghosts);
+        APF_ITERATE(Copies, ghosts, git)
+          peers.insert(git->first);
+      }
+    }
+    m->end(it);
+  }
+  peers.erase(m->getId());
+  std::vector<int> ranks(peers.begin(), peers.end());
+  PCU_Comm_Set_Neighbors(ranks.empty() ? 0 : &ranks[0], ranks.size());
+}
+
 static bool residesOn(Mesh* m, MeshEntity* e, int part)
 {
   Parts residence;
@@ -489,16 +553,21 @@ static bool sameContent(int n, MeshEntity** a, MeshEntity** b)
 MeshEntity* findUpward(Mesh* m, int type, MeshEntity** down)
 {
   if ( ! down[0]) return 0;
+  return m->findUpward_(type,down);
+}
+
+MeshEntity* Mesh::findUpward_(int type, MeshEntity** down)
+{
   Up ups;
-  m->getUp(down[0],ups);
+  getUp(down[0],ups);
   int d = Mesh::typeDimension[type];
   int nd = Mesh::adjacentCount[type][d-1];
   Downward down2;
   for (int i=0; i < ups.n; ++i)
   {
     MeshEntity* up = ups.e[i];
-    if (m->getType(up)!=type) continue;
-    m->getDownward(up,d-1,down2);
+    if (getType(up)!=type) continue;
+    getDownward(up,d-1,down2);
     if (sameContent(nd,down,down2))
       return up;
   }
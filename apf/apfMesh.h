@@ -126,6 +126,19 @@ class Mesh
         \details an end() call should match every begin()
                  call to prevent memory leaks */
     virtual void end(MeshIterator* it) = 0;
+    /** \brief begins iteration over one of (ranges) disjoint
+               pieces of the entities of one dimension
+        \details the pieces together cover the whole dimension, and
+                 iterators over different pieces may be used concurrently
+                 for read-only traversal (see apf::parallelFor).
+                 iterate and end are used on the result as usual.
+                 Meshes that cannot do this return 0, which is the
+                 default implementation. */
+    virtual MeshIterator* beginRange(int dimension, int range, int ranges);
+    /** \brief Implementation-defined code for apf::findUpward
+        \details the default searches the upward adjacencies of down[0]
+                 through getUp and getDownward. */
+    virtual MeshEntity* findUpward_(int type, MeshEntity** down);
 // seol
     // return true if adjacency *from_dim <--> to_dim*  is stored
     virtual bool hasAdjacency(int from_dim, int to_dim) = 0;
@@ -293,6 +306,11 @@ class Mesh
     bool canGetModelNormal();
     /** \brief evaluate parametric coordinate (p) as a spatial point (x) */
     void snapToModel(ModelEntity* m, Vector3 const& p, Vector3& x);
+    /** \brief evaluate (n) parametric coordinates at once
+      \details point (i) is p[i] on model entity g[i]. this lets
+      the geometric model amortize its work over many points */
+    void snapToModel(int n, ModelEntity* const* g, Vector3 const* p,
+        Vector3* x);
     /** \brief reparameterize mesh vertex (e) onto model entity (g) */
     void getParamOn(ModelEntity* g, MeshEntity* e, Vector3& p);
     /** \brief get the periodic properties of a model entity
@@ -547,6 +565,18 @@ extern int const pyramid_tri_verts[4][3];
 /** \brief scan the part for [vtx|edge|face]-adjacent part ids */
 void getPeers(Mesh* m, int d, Parts& peers);
 
+/** \brief declare the parts sharing vertices with this one
+           as its PCU neighbors
+  \details this calls PCU_Comm_Set_Neighbors with all parts that hold
+  remote copies or matches of local vertices, plus the parts holding
+  ghosts of local entities or owning local ghosts, which covers the
+  messages sent by apf::synchronize, apf::accumulate and similar
+  operations.
+  Must be called by all ranks. Migration and apf::Mesh::verify send
+  messages to other parts as well, and the set becomes stale as soon as
+  the partition changes, so call PCU_Comm_Unset_Neighbors before those. */
+void declareNeighbors(Mesh* m);
+
 /** \brief find pointer (e) in array (a) of length (n)
   \returns -1 if not found, otherwise i such that a[i] = e */
 int findIn(MeshEntity** a, int n, MeshEntity* e);
@@ -25,6 +25,10 @@ MeshEntity* Mesh2::createVertex(ModelEntity* c, Vector3 const& point,
   return v;
 }
 
+void Mesh2::reserve(int, size_t)
+{
+}
+
 void displaceMesh(Mesh2* m, Field* d, double factor)
 {
   m->getCoordinateField()->axpy(factor,d);
@@ -103,6 +103,11 @@ class Mesh2 : public Mesh
       requireUnfrozen();
       destroy_(e);
     }
+/** \brief make room for (n) more entities of one type
+  \details this is only a hint given before creating many entities,
+  so that the mesh can grow its storage once instead of repeatedly.
+  The default implementation does nothing. */
+    virtual void reserve(int type, size_t n);
 /** \brief Change the geometric classification of an entity. */
     virtual void setModelEntity(MeshEntity* e, ModelEntity* c) = 0;
 /** \brief Add a matched copy to an entity */
@@ -129,11 +134,11 @@ void migrate(Mesh2* m, Migration* plan);
 void migrateSilent(Mesh2* m, Migration* plan);
 
 /** \brief set the maximum elements that apf::migrate moves at once
-  \details apf::migrate implements gradual limited migration
-  in an effort to help applications keep memory use to a minimum.
-  This function globally sets the limit on migration, which
-  causes any migration requests greater than the limit to
-  be performed as several consecutive migrations. */
+  \details by default there is no limit and apf::migrate moves
+  everything in one communication phase, however large.
+  Applications that need to keep peak memory use down can set
+  a limit here, which causes any migration requests greater than
+  the limit to be performed as several consecutive migrations. */
 void setMigrationLimit(size_t maxElements);
 
 class Field;
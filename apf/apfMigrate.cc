@@ -10,8 +10,8 @@
 #include "apfCavityOp.h"
 #include "apf.h"
 #include <pcu_util.h>
-#include <lionPrint.h>
 #include <cstdlib>
+#include <limits>
 
 namespace apf {
 
@@ -855,17 +855,14 @@ static void migrate1(Mesh2* m, Migration* plan)
   m->acceptChanges();
 }
 
-const size_t maxMigrationLimit = 10*1000*1000;
-static size_t migrationLimit = maxMigrationLimit;
+/* PCU splits messages larger than INT_MAX bytes, so by default
+   everything moves in one phase and the limit only serves
+   to trade time for peak memory */
+static size_t migrationLimit = std::numeric_limits<size_t>::max();
 
 void setMigrationLimit(size_t maxElements)
 {
-  if( maxElements >= maxMigrationLimit ) {
-    if(!PCU_Comm_Self())
-      lion_eprint(1, "ERROR requested migration limit exceeds"
-                      " %lu... exiting\n", maxMigrationLimit);
-    abort();
-  }
+  PCU_ALWAYS_ASSERT(maxElements > 0);
   migrationLimit = maxElements;
 }
 
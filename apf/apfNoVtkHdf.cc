@@ -0,0 +1,22 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apf.h"
+
+namespace apf {
+
+void writeVtkHdfFiles(const char*, Mesh*, std::vector<std::string>, int)
+{
+  fail("apf::writeVtkHdfFiles: apf was built without APF_VTKHDF\n");
+}
+
+void writeVtkHdfFiles(const char*, Mesh*, int)
+{
+  fail("apf::writeVtkHdfFiles: apf was built without APF_VTKHDF\n");
+}
+
+}
@@ -39,6 +39,11 @@ void FieldShape::getNodeXi(int, int, Vector3&)
   fail("unimplemented getNodeXi called");
 }
 
+bool FieldShape::dependsOnEntity()
+{
+  return true;
+}
+
 void FieldShape::registerSelf(const char* name_)
 {
   std::string name = name_;
@@ -73,6 +78,7 @@ class Linear : public FieldShape
   public:
     Linear() { registerSelf(apf::Linear::getName()); }
     const char* getName() const { return "Linear"; }
+    bool dependsOnEntity() { return false; }
     class Vertex : public EntityShape
     {
       public:
@@ -356,6 +362,7 @@ class Linear : public FieldShape
 class QuadraticBase : public FieldShape
 {
   public:
+    bool dependsOnEntity() {return false;}
     class Edge : public EntityShape
     {
       public:
@@ -648,6 +655,7 @@ class LagrangeCubic : public FieldShape
   public:
     LagrangeCubic() { registerSelf(apf::LagrangeCubic::getName()); }
     const char* getName() const { return "Lagrange Cubic"; }
+    bool dependsOnEntity() { return false; }
     class Vertex : public EntityShape
     {
       public:
@@ -918,6 +926,10 @@ class Constant : public FieldShape
     {
       return name.c_str();
     }
+    bool dependsOnEntity()
+    {
+      return false;
+    }
     class Element : public EntityShape
     {
       public:
@@ -96,6 +96,12 @@ class FieldShape
     virtual void getNodeXi(int type, int node, Vector3& xi);
 /** \brief Get a unique string for this shape function scheme */
     virtual const char* getName() const = 0;
+/** \brief Return true if the shape function values depend on the
+           element and not only on its type
+  \details when this is false, the values and local gradients of
+  the apf::EntityShape of a type may be evaluated once for all
+  elements of that type. It is true by default. */
+    virtual bool dependsOnEntity();
     void registerSelf(const char* name);
 };
 
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfShapeTable.h"
+#include "apfShape.h"
+#include "apfMesh.h"
+#include "apfIntegrate.h"
+#include <pthread.h>
+#include <map>
+
+namespace apf {
+
+ShapeTable::ShapeTable(FieldShape* s, int type, int order)
+{
+  Integration const* integration = getIntegration(type)->getAccurate(order);
+  EntityShape* es = s->getEntityShape(type);
+  points = integration->countPoints();
+  nodes = es->countNodes();
+  xi.resize(points);
+  weights.resize(points);
+  values.resize(points * nodes);
+  gradients.assign(points * nodes, Vector3(0,0,0));
+  int dimension = Mesh::typeDimension[type];
+  NewArray<double> v;
+  NewArray<Vector3> g;
+  for (int p = 0; p < points; ++p) {
+    IntegrationPoint const* ip = integration->getPoint(p);
+    xi[p] = ip->param;
+    weights[p] = ip->weight;
+    /* the shape does not depend on the element,
+       so there is no mesh or element to give it */
+    es->getValues(0, 0, xi[p], v);
+    for (int k = 0; k < nodes; ++k)
+      values[p * nodes + k] = v[k];
+    /* vertex shapes leave their gradients unset */
+    if (!dimension)
+      continue;
+    es->getLocalGradients(0, 0, xi[p], g);
+    for (int k = 0; k < nodes; ++k)
+      gradients[p * nodes + k] = g[k];
+  }
+}
+
+namespace {
+
+struct TableKey
+{
+  FieldShape* shape;
+  int type;
+  Integration const* rule;
+  bool operator<(TableKey const& o) const
+  {
+    if (shape != o.shape)
+      return shape < o.shape;
+    if (type != o.type)
+      return type < o.type;
+    return rule < o.rule;
+  }
+};
+
+typedef std::map<TableKey, ShapeTable> Tables;
+
+pthread_mutex_t tablesLock = PTHREAD_MUTEX_INITIALIZER;
+
+Tables& getTables()
+{
+  static Tables tables;
+  return tables;
+}
+
+/* each thread remembers its last few lookups, so that loops
+   which alternate between a field shape and the coordinate
+   shape do not take the lock on every call */
+struct RecentTable
+{
+  FieldShape* shape;
+  int type;
+  int order;
+  ShapeTable const* table;
+};
+
+enum { RECENT = 4 };
+
+thread_local RecentTable recent[RECENT];
+thread_local int nextRecent = 0;
+
+}
+
+ShapeTable const* getShapeTable(FieldShape* s, int type, int order)
+{
+  for (int i = 0; i < RECENT; ++i)
+    if (recent[i].shape == s &&
+        recent[i].type == type &&
+        recent[i].order == order)
+      return recent[i].table;
+  ShapeTable const* table = 0;
+  Integration const* rule = 0;
+  EntityIntegration const* ei = getIntegration(type);
+  if (ei && !s->dependsOnEntity() && s->getEntityShape(type))
+    rule = ei->getAccurate(order);
+  if (rule) {
+    TableKey key;
+    key.shape = s;
+    key.type = type;
+    key.rule = rule;
+    pthread_mutex_lock(&tablesLock);
+    Tables& tables = getTables();
+    Tables::iterator it = tables.find(key);
+    if (it == tables.end())
+      it = tables.insert(
+          std::make_pair(key, ShapeTable(s, type, order))).first;
+    table = &it->second;
+    pthread_mutex_unlock(&tablesLock);
+  }
+  RecentTable& r = recent[nextRecent];
+  nextRecent = (nextRecent + 1) % RECENT;
+  r.shape = s;
+  r.type = type;
+  r.order = order;
+  r.table = table;
+  return table;
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_SHAPE_TABLE_H
+#define APF_SHAPE_TABLE_H
+
+/** \file apfShapeTable.h
+  \brief shape functions tabulated at integration points */
+
+#include "apfVector.h"
+#include <vector>
+
+namespace apf {
+
+class FieldShape;
+
+/** \brief the shape functions of one element type,
+  evaluated at the points of one integration rule
+  \details values and local gradients are stored node-fastest,
+  so getValues(p)[k] is the value of node (k) at point (p). */
+class ShapeTable
+{
+  public:
+    ShapeTable(FieldShape* s, int type, int order);
+    int countPoints() const {return points;}
+    int countNodes() const {return nodes;}
+    /** \brief parent coordinates of an integration point */
+    Vector3 const& getPoint(int p) const {return xi[p];}
+    double getWeight(int p) const {return weights[p];}
+    double const* getValues(int p) const {return &values[p * nodes];}
+    Vector3 const* getLocalGradients(int p) const
+    {
+      return &gradients[p * nodes];
+    }
+  private:
+    int points;
+    int nodes;
+    std::vector<Vector3> xi;
+    std::vector<double> weights;
+    std::vector<double> values;
+    std::vector<Vector3> gradients;
+};
+
+/** \brief get the shape functions of (s) for elements of (type)
+  tabulated at the integration points of accuracy (order)
+  \details tables are built on first use and kept until the program
+  exits. Rules that serve several orders share one table.
+  This may be called from several threads at once.
+  Returns zero if the shape depends on the element
+  (apf::FieldShape::dependsOnEntity), has no functions for this type,
+  or there is no integration of this order, in which case
+  callers should evaluate the apf::EntityShape themselves. */
+ShapeTable const* getShapeTable(FieldShape* s, int type, int order);
+
+}
+
+#endif
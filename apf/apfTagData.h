@@ -88,6 +88,7 @@ class TagData
     bool hasEntity(MeshEntity* e);
     void removeEntity(MeshEntity* e);
     MeshTag* getTag(MeshEntity* e);
+    MeshTag* getTypeTag(int type) {return tags[type];}
     MeshTag* makeOrFindTag(const char* name, int size);
     void rename(const char* newName);
   private:
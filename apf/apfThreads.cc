@@ -0,0 +1,129 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfThreads.h"
+#include "apfMesh.h"
+#include <pcu_util.h>
+#include <pthread.h>
+#include <vector>
+
+namespace apf {
+
+static int threadCount = 1;
+
+void setThreadCount(int n)
+{
+  PCU_ALWAYS_ASSERT(n > 0);
+  threadCount = n;
+}
+
+int getThreadCount()
+{
+  return threadCount;
+}
+
+struct RangeWork
+{
+  Mesh* mesh;
+  int dimension;
+  ParallelOp* op;
+  int range;
+  int ranges;
+};
+
+static void* runRange(void* arg)
+{
+  RangeWork* w = static_cast<RangeWork*>(arg);
+  MeshIterator* it = w->mesh->beginRange(w->dimension, w->range, w->ranges);
+  MeshEntity* e;
+  while ((e = w->mesh->iterate(it)))
+    w->op->apply(e, w->range);
+  w->mesh->end(it);
+  return 0;
+}
+
+static void runSerial(Mesh* m, int dimension, ParallelOp& op)
+{
+  MeshIterator* it = m->begin(dimension);
+  MeshEntity* e;
+  while ((e = m->iterate(it)))
+    op.apply(e, 0);
+  m->end(it);
+}
+
+void parallelFor(Mesh* m, int dimension, ParallelOp& op)
+{
+  int n = threadCount;
+  MeshIterator* probe = 0;
+  if (n > 1)
+    probe = m->beginRange(dimension, 0, n);
+  if (!probe)
+    return runSerial(m, dimension, op);
+  m->end(probe);
+  std::vector<RangeWork> work(n);
+  for (int i = 0; i < n; ++i) {
+    work[i].mesh = m;
+    work[i].dimension = dimension;
+    work[i].op = &op;
+    work[i].range = i;
+    work[i].ranges = n;
+  }
+  /* the calling thread takes range zero */
+  std::vector<pthread_t> threads(n);
+  for (int i = 1; i < n; ++i) {
+    int err = pthread_create(&threads[i], 0, runRange, &work[i]);
+    PCU_ALWAYS_ASSERT_VERBOSE(!err, "apf::parallelFor: pthread_create failed");
+  }
+  runRange(&work[0]);
+  for (int i = 1; i < n; ++i)
+    pthread_join(threads[i], 0);
+}
+
+struct BlockWork
+{
+  ParallelLoop* op;
+  int begin;
+  int end;
+  int thread;
+};
+
+static void* runBlock(void* arg)
+{
+  BlockWork* w = static_cast<BlockWork*>(arg);
+  for (int i = w->begin; i < w->end; ++i)
+    w->op->apply(i, w->thread);
+  return 0;
+}
+
+void parallelFor(int n, ParallelLoop& op)
+{
+  int nt = threadCount;
+  if (nt > n)
+    nt = n;
+  if (nt < 2) {
+    for (int i = 0; i < n; ++i)
+      op.apply(i, 0);
+    return;
+  }
+  std::vector<BlockWork> work(nt);
+  for (int i = 0; i < nt; ++i) {
+    work[i].op = &op;
+    work[i].begin = (long(n) * i) / nt;
+    work[i].end = (long(n) * (i + 1)) / nt;
+    work[i].thread = i;
+  }
+  std::vector<pthread_t> threads(nt);
+  for (int i = 1; i < nt; ++i) {
+    int err = pthread_create(&threads[i], 0, runBlock, &work[i]);
+    PCU_ALWAYS_ASSERT_VERBOSE(!err, "apf::parallelFor: pthread_create failed");
+  }
+  runBlock(&work[0]);
+  for (int i = 1; i < nt; ++i)
+    pthread_join(threads[i], 0);
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APF_THREADS_H
+#define APF_THREADS_H
+
+/** \file apfThreads.h
+  \brief shared-memory threaded traversal of a mesh part */
+
+namespace apf {
+
+class Mesh;
+class MeshEntity;
+
+/** \brief a read-only operation applied to each entity by parallelFor
+  \details apply may be called concurrently from several threads,
+  so it must not modify the mesh and any state it accumulates should
+  be kept separately per thread index. */
+class ParallelOp
+{
+  public:
+    virtual ~ParallelOp() {}
+    /** \brief apply the operation to one entity
+      \param thread index of the calling thread,
+                    in the range [0, apf::getThreadCount()) */
+    virtual void apply(MeshEntity* e, int thread) = 0;
+};
+
+/** \brief an operation applied to each index of a range by parallelFor
+  \details the same rules as for ParallelOp apply, this is for work
+  that has already been gathered out of the mesh into arrays. */
+class ParallelLoop
+{
+  public:
+    virtual ~ParallelLoop() {}
+    /** \brief apply the operation to one index
+      \param thread index of the calling thread,
+                    in the range [0, apf::getThreadCount()) */
+    virtual void apply(int i, int thread) = 0;
+};
+
+/** \brief set the number of threads used by apf::parallelFor
+  \details the default is one, which runs everything in the calling
+  thread exactly like a serial loop over the mesh. */
+void setThreadCount(int n);
+
+/** \brief get the number of threads used by apf::parallelFor */
+int getThreadCount();
+
+/** \brief apply an operation to all entities of one dimension
+  \details if the mesh supports apf::Mesh::beginRange and more than
+  one thread is requested, each thread traverses a disjoint range
+  of the entities. Otherwise this is a serial loop with thread index 0.
+  Returns once all entities have been visited. */
+void parallelFor(Mesh* m, int dimension, ParallelOp& op);
+
+/** \brief apply an operation to all indices in [0, n)
+  \details each thread takes one contiguous block of indices.
+  with one thread this is a serial loop in increasing order. */
+void parallelFor(int n, ParallelLoop& op);
+
+}
+
+#endif
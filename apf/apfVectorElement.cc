@@ -7,6 +7,7 @@
 
 #include "apfVectorElement.h"
 #include "apfVectorField.h"
+#include "apfShapeTable.h"
 
 namespace apf {
 
@@ -98,4 +99,23 @@ double VectorElement::getDV(Vector3 const& xi)
   return getJacobianDeterminant(J,getDimension());
 }
 
+void VectorElement::getJacobian(int order, int point, Matrix3x3& J)
+{
+  ShapeTable const* t = getShapeTable(field->getShape(), getType(), order);
+  if (!t)
+    return getJacobian(getIntPoint(order, point), J);
+  Vector3 const* localGradients = t->getLocalGradients(point);
+  Vector3* nodeValues = getNodeValues();
+  J = tensorProduct(localGradients[0],nodeValues[0]);
+  for (int i=1; i < nen; ++i)
+    J = J + tensorProduct(localGradients[i],nodeValues[i]);
+}
+
+double VectorElement::getDV(int order, int point)
+{
+  Matrix3x3 J;
+  getJacobian(order,point,J);
+  return getJacobianDeterminant(J,getDimension());
+}
+
 }//namespace apf
@@ -25,7 +25,9 @@ class VectorElement : public ElementOf<Vector3>
     void grad(Vector3 const& xi, Matrix3x3& g);
     void curl(Vector3 const& xi, Vector3& c);
     void getJacobian(Vector3 const& xi, Matrix3x3& J);
+    void getJacobian(int order, int point, Matrix3x3& J);
     double getDV(Vector3 const& xi);
+    double getDV(int order, int point);
     void gradHelper(NewArray<Vector3>& nodalGradients, Matrix3x3& g);
 };
 
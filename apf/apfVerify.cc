@@ -4,6 +4,7 @@
 #include <gmi.h>
 #include <sstream>
 #include <apfGeometry.h>
+#include "apfThreads.h"
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include "stdlib.h" // malloc
@@ -458,30 +459,50 @@ static long verifyCoords(Mesh* m)
   return PCU_Add_Long(n);
 }
 
-long verifyVolumes(Mesh* m, bool printVolumes)
+class VolumeChecker : public ParallelOp
 {
-  MeshIterator* it = m->begin(m->getDimension());
-  MeshEntity* e;
-  long n = 0;
-  while ((e = m->iterate(it)))
-  {
-    if (!isSimplex(m->getType(e)))
-      continue;
-    double v = measure(m,e);
-    if (v < 0) {
-      if (printVolumes) {
-        std::stringstream ss;
-        ss << "warning: element volume " << v
-          << " at " << getLinearCentroid(m, e) << '\n';
-        std::string s = ss.str();
-        lion_oprint(1, "%s", s.c_str());
-        fflush(stdout);
+  public:
+    VolumeChecker(Mesh* m, bool p):
+      mesh(m),
+      printVolumes(p),
+      negative(getThreadCount(), 0)
+    {
+    }
+    void apply(MeshEntity* e, int thread)
+    {
+      if (!isSimplex(mesh->getType(e)))
+        return;
+      double v = measure(mesh,e);
+      if (v < 0) {
+        if (printVolumes) {
+          std::stringstream ss;
+          ss << "warning: element volume " << v
+            << " at " << getLinearCentroid(mesh, e) << '\n';
+          std::string s = ss.str();
+          lion_oprint(1, "%s", s.c_str());
+          fflush(stdout);
+        }
+        ++negative[thread];
       }
-      ++n;
     }
-  }
-  m->end(it);
-  return PCU_Add_Long(n);
+    long count()
+    {
+      long n = 0;
+      for (size_t i = 0; i < negative.size(); ++i)
+        n += negative[i];
+      return n;
+    }
+  private:
+    Mesh* mesh;
+    bool printVolumes;
+    std::vector<long> negative;
+};
+
+long verifyVolumes(Mesh* m, bool printVolumes)
+{
+  VolumeChecker checker(m, printVolumes);
+  parallelFor(m, m->getDimension(), checker);
+  return PCU_Add_Long(checker.count());
 }
 
 static void packAlignment(Mesh* m, MeshEntity* e, MeshEntity* r, int to)
@@ -18,9 +18,12 @@
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
 #include <stdint.h>
 #include <vector>
 #include <apfVtk.h>
+#include "apfVtkArrays.h"
 
 // === includes for safe_mkdir ===
 #include <reel.h>
@@ -530,6 +533,24 @@ static void writeOffsets(std::ostream& file,
   file << "</DataArray>\n";
 }
 
+static int getVtkType(int type, int order)
+{
+  static int vtkTypes[Mesh::TYPES][2] =
+    /* order
+       linear,quadratic
+       V  V */
+    {{ 1,-1}//vertex
+    ,{ 3,21}//edge
+    ,{ 5,22}//triangle
+    ,{ 9,23}//quad
+    ,{10,24}//tet
+    ,{12,25}//hex
+    ,{13,-1}//prism
+    ,{14,-1}//pyramid
+  };
+  return vtkTypes[type][order-1];
+}
+
 static void writeTypes(std::ostream& file,
     Mesh* m,
     bool isWritingBinary,
@@ -547,19 +568,6 @@ static void writeTypes(std::ostream& file,
   file << ">\n";
   MeshEntity* e;
   int order = m->getShape()->getOrder();
-  static int vtkTypes[Mesh::TYPES][2] =
-    /* order
-       linear,quadratic
-       V  V */
-    {{ 1,-1}//vertex
-    ,{ 3,21}//edge
-    ,{ 5,22}//triangle
-    ,{ 9,23}//quad
-    ,{10,24}//tet
-    ,{12,25}//hex
-    ,{13,-1}//prism
-    ,{14,-1}//pyramid
-  };
   if (isWritingBinary)
   {
     unsigned int dataLen = 0;
@@ -575,7 +583,7 @@ static void writeTypes(std::ostream& file,
     unsigned int dataIndex = 0;
     while ((e = m->iterate(elements)))
     {
-      dataToEncode[dataIndex] = vtkTypes[m->getType(e)][order-1];
+      dataToEncode[dataIndex] = getVtkType(m->getType(e), order);
       dataIndex++;
     }
     m->end(elements);
@@ -587,7 +595,7 @@ static void writeTypes(std::ostream& file,
     MeshIterator* elements = m->begin(cellDim);
     while ((e = m->iterate(elements)))
     {
-      file << vtkTypes[m->getType(e)][order-1] << '\n';
+      file << getVtkType(m->getType(e), order) << '\n';
     }
     m->end(elements);
   }
@@ -1014,4 +1022,398 @@ void writeASCIIVtkFiles(const char* prefix, Mesh* m)
   writeASCIIVtkFiles(prefix, m, writeFields);
 }
 
+
+/* The writer below puts the bytes of each array after the XML of
+   its piece (format="appended", encoding="raw"). This avoids the
+   base64 text of the writers above, which is a third bigger, and
+   the whole piece is never held in memory as text. Each array is
+   preceded by a UInt64 byte count, or with compression by the
+   vtkZLibDataCompressor header of block sizes. */
+
+static const char* getRawTypeName(int type)
+{
+  static const char* names[5] =
+    {"Float64","Int32","Int64","Float32","UInt8"};
+  return names[type];
+}
+
+size_t getRawTypeSize(int type)
+{
+  static size_t sizes[5] = {8, 4, 8, 4, 1};
+  return sizes[type];
+}
+
+/* the size of the compressed blocks before compression */
+static const size_t rawBlockSize = 1 << 20;
+
+/* the size of the buffer given to the stdio file */
+static const size_t rawFileBuffer = 1 << 22;
+
+RawArrays::RawArrays(Numbering* n,
+    std::vector<std::string> const& writeFields,
+    bool f32,
+    int d):
+  mesh(n->getMesh()),
+  numbering(n),
+  writeFloat32(f32),
+  cellDim(d)
+{
+  getNodes(n, nodes);
+  cells = mesh->count(cellDim);
+  addField(mesh->getCoordinateField(), RAW_NODAL);
+  size_t connectivity = 0;
+  MeshIterator* it = mesh->begin(cellDim);
+  MeshEntity* e;
+  while ((e = mesh->iterate(it)))
+    connectivity += countElementNodes(n, e);
+  mesh->end(it);
+  addArray("connectivity", RAW_CONNECTIVITY, Mesh::INT, 1, 0, 0,
+      connectivity);
+  addArray("offsets", RAW_OFFSETS, Mesh::INT, 1, 0, 0, cells);
+  addArray("types", RAW_TYPES, RAW_UINT8, 1, 0, 0, cells);
+  pointData = arrays.size();
+  addFields(writeFields, RAW_NODAL);
+  cellData = arrays.size();
+  addFields(writeFields, RAW_IP);
+  addArray("apf_part", RAW_PARTS, Mesh::INT, 1, 0, 0, cells);
+}
+
+void RawArrays::addArray(std::string const& name, int source, int type,
+    int components, FieldBase* f, int point, size_t values)
+{
+  RawArray a;
+  a.name = name;
+  a.source = source;
+  a.type = type;
+  a.components = components;
+  a.field = f;
+  a.point = point;
+  a.values = values;
+  a.bytes = sizeof(uint64_t) + values * getRawTypeSize(type);
+  arrays.push_back(a);
+}
+
+void RawArrays::addField(FieldBase* f, int source)
+{
+  int type = f->getScalarType();
+  if (type == Mesh::DOUBLE && writeFloat32)
+    type = RAW_FLOAT32;
+  int nc = f->countComponents();
+  if (source == RAW_NODAL) {
+    addArray(f->getName(), source, type, nc, f, 0, nodes.getSize() * nc);
+    return;
+  }
+  int n = countIPs(f, cellDim);
+  for (int p = 0; p < n; ++p)
+    addArray(getIPName(f, p), source, type, nc, f, p, cells * nc);
+}
+
+void RawArrays::addFields(std::vector<std::string> const& writeFields,
+    int source)
+{
+  std::vector<FieldBase*> fields;
+  for (int i=0; i < mesh->countFields(); ++i)
+    fields.push_back(mesh->getField(i));
+  for (int i=0; i < mesh->countNumberings(); ++i)
+    fields.push_back(mesh->getNumbering(i));
+  for (int i=0; i < mesh->countGlobalNumberings(); ++i)
+    fields.push_back(mesh->getGlobalNumbering(i));
+  for (size_t i=0; i < fields.size(); ++i)
+  {
+    FieldBase* f = fields[i];
+    bool isSource = (source == RAW_NODAL) ? isNodal(f) : isIP(f, cellDim);
+    if (isSource && shouldPrint(f, writeFields))
+      addField(f, source);
+  }
+}
+
+template <class T, class O>
+void RawArrays::fillField(RawArray& a, O* out)
+{
+  int nc = a.components;
+  NewArray<T> values(nc);
+  FieldDataOf<T>* data = static_cast<FieldDataOf<T>*>(a.field->getData());
+  if (a.source == RAW_NODAL)
+  {
+    for (size_t i = 0; i < nodes.getSize(); ++i)
+    {
+      data->getNodeComponents(nodes[i].entity, nodes[i].node, &values[0]);
+      for (int j = 0; j < nc; ++j)
+        out[i * nc + j] = values[j];
+    }
+    return;
+  }
+  MeshIterator* it = mesh->begin(cellDim);
+  MeshEntity* e;
+  size_t i = 0;
+  while ((e = mesh->iterate(it)))
+  {
+    data->getNodeComponents(e, a.point, &values[0]);
+    for (int j = 0; j < nc; ++j)
+      out[i * nc + j] = values[j];
+    ++i;
+  }
+  mesh->end(it);
+}
+
+void RawArrays::fill(RawArray& a, std::vector<char>& out)
+{
+  out.resize(a.values * getRawTypeSize(a.type));
+  if (out.empty())
+    return;
+  void* p = &out[0];
+  if (a.field)
+  {
+    switch (a.type)
+    {
+      case RAW_FLOAT32:
+        return fillField<double>(a, static_cast<float*>(p));
+      case Mesh::DOUBLE:
+        return fillField<double>(a, static_cast<double*>(p));
+      case Mesh::INT:
+        return fillField<int>(a, static_cast<int*>(p));
+      case Mesh::LONG:
+        return fillField<long>(a, static_cast<long*>(p));
+    }
+  }
+  int order = mesh->getShape()->getOrder();
+  int id = mesh->getId();
+  int* ints = static_cast<int*>(p);
+  uint8_t* bytes = static_cast<uint8_t*>(p);
+  NewArray<int> numbers;
+  size_t i = 0;
+  int offset = 0;
+  MeshIterator* it = mesh->begin(cellDim);
+  MeshEntity* e;
+  while ((e = mesh->iterate(it)))
+  {
+    if (a.source == RAW_CONNECTIVITY)
+    {
+      int nen = countElementNodes(numbering, e);
+      getElementNumbers(numbering, e, numbers);
+      for (int j = 0; j < nen; ++j)
+        ints[i++] = numbers[j];
+    }
+    else if (a.source == RAW_OFFSETS)
+    {
+      offset += countElementNodes(numbering, e);
+      ints[i++] = offset;
+    }
+    else if (a.source == RAW_TYPES)
+      bytes[i++] = getVtkType(mesh->getType(e), order);
+    else
+      ints[i++] = id;
+  }
+  mesh->end(it);
+}
+
+class RawVtuWriter : public RawArrays
+{
+  public:
+    RawVtuWriter(Numbering* n,
+        std::vector<std::string> const& writeFields,
+        int compression,
+        bool writeFloat32,
+        int cellDim);
+    void writePvtu(const char* prefix);
+    /* returns the number of bytes written */
+    size_t writeVtu(const char* prefix);
+  private:
+    void compress(RawArray& a, std::vector<char> const& data);
+    void describe(std::ostream& file, RawArray& a, const char* tag);
+    void writeSection(std::ostream& file, const char* tag,
+        size_t begin, size_t end, size_t& offset);
+    int compression;
+};
+
+RawVtuWriter::RawVtuWriter(Numbering* n,
+    std::vector<std::string> const& writeFields,
+    int c,
+    bool f32,
+    int d):
+  RawArrays(n, writeFields, f32, d),
+  compression(lion::can_compress ? c : 0)
+{
+}
+
+void RawVtuWriter::compress(RawArray& a, std::vector<char> const& data)
+{
+  size_t size = data.size();
+  size_t n = (size + rawBlockSize - 1) / rawBlockSize;
+  std::vector<uint64_t> header(3 + n);
+  header[0] = n;
+  header[1] = rawBlockSize;
+  header[2] = size - (n ? (n - 1) * rawBlockSize : 0);
+  size_t headerBytes = header.size() * sizeof(uint64_t);
+  a.blocks.resize(headerBytes);
+  std::vector<char> block(lion::compressBound(rawBlockSize));
+  for (size_t i = 0; i < n; ++i)
+  {
+    unsigned long inLen = (i + 1 < n) ? rawBlockSize : header[2];
+    unsigned long outLen = block.size();
+    lion::compress(&block[0], outLen, &data[i * rawBlockSize], inLen,
+        compression);
+    header[3 + i] = outLen;
+    a.blocks.insert(a.blocks.end(), block.begin(), block.begin() + outLen);
+  }
+  memcpy(&a.blocks[0], &header[0], headerBytes);
+  a.bytes = a.blocks.size();
+}
+
+void RawVtuWriter::describe(std::ostream& file, RawArray& a, const char* tag)
+{
+  file << '<' << tag << " type=\"" << getRawTypeName(a.type);
+  file << "\" Name=\"" << a.name;
+  file << "\" NumberOfComponents=\"" << a.components << '"';
+}
+
+void RawVtuWriter::writeSection(std::ostream& file, const char* tag,
+    size_t begin, size_t end, size_t& offset)
+{
+  file << '<' << tag << ">\n";
+  for (size_t i = begin; i < end; ++i)
+  {
+    describe(file, arrays[i], "DataArray");
+    file << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+    offset += arrays[i].bytes;
+  }
+  file << "</" << tag << ">\n";
+}
+
+void RawVtuWriter::writePvtu(const char* prefix)
+{
+  std::string fileName = stripPath(prefix);
+  fileName += ".pvtu";
+  std::stringstream ss;
+  ss << prefix << '/' << fileName;
+  std::string fileNameAndPath = ss.str();
+  std::ofstream file(fileNameAndPath.c_str());
+  PCU_ALWAYS_ASSERT(file.is_open());
+  file << "<VTKFile type=\"PUnstructuredGrid\">\n";
+  file << "<PUnstructuredGrid GhostLevel=\"0\">\n";
+  file << "<PPoints>\n";
+  describe(file, arrays[0], "PDataArray");
+  file << "/>\n</PPoints>\n";
+  file << "<PPointData>\n";
+  for (size_t i = pointData; i < cellData; ++i)
+  {
+    describe(file, arrays[i], "PDataArray");
+    file << "/>\n";
+  }
+  file << "</PPointData>\n";
+  file << "<PCellData>\n";
+  for (size_t i = cellData; i < arrays.size(); ++i)
+  {
+    describe(file, arrays[i], "PDataArray");
+    file << "/>\n";
+  }
+  file << "</PCellData>\n";
+  writePSources(file);
+  file << "</PUnstructuredGrid>\n";
+  file << "</VTKFile>\n";
+}
+
+size_t RawVtuWriter::writeVtu(const char* prefix)
+{
+  std::vector<char> data;
+  if (compression)
+    for (size_t i = 0; i < arrays.size(); ++i)
+    {
+      fill(arrays[i], data);
+      compress(arrays[i], data);
+    }
+  std::stringstream xml;
+  xml << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\"";
+  xml << " byte_order=\"";
+  xml << (isBigEndian() ? "BigEndian" : "LittleEndian") << '"';
+  xml << " header_type=\"UInt64\"";
+  if (compression)
+    xml << " compressor=\"vtkZLibDataCompressor\"";
+  xml << ">\n";
+  xml << "<UnstructuredGrid>\n";
+  xml << "<Piece NumberOfPoints=\"" << nodes.getSize();
+  xml << "\" NumberOfCells=\"" << cells;
+  xml << "\">\n";
+  size_t offset = 0;
+  writeSection(xml, "Points", 0, 1, offset);
+  writeSection(xml, "Cells", 1, pointData, offset);
+  writeSection(xml, "PointData", pointData, cellData, offset);
+  writeSection(xml, "CellData", cellData, arrays.size(), offset);
+  xml << "</Piece>\n";
+  xml << "</UnstructuredGrid>\n";
+  xml << "<AppendedData encoding=\"raw\">\n_";
+  std::string head = xml.str();
+  std::string tail = "\n</AppendedData>\n</VTKFile>\n";
+  std::string fileName = getPieceFileName(PCU_Comm_Self());
+  std::string fileNameAndPath =
+    getFileNameAndPathVtu(prefix, fileName, PCU_Comm_Self());
+  FILE* file = fopen(fileNameAndPath.c_str(), "wb");
+  PCU_ALWAYS_ASSERT(file);
+  std::vector<char> buffer(rawFileBuffer);
+  setvbuf(file, &buffer[0], _IOFBF, buffer.size());
+  fwrite(head.c_str(), 1, head.size(), file);
+  for (size_t i = 0; i < arrays.size(); ++i)
+  {
+    RawArray& a = arrays[i];
+    if (compression)
+    {
+      fwrite(&a.blocks[0], 1, a.blocks.size(), file);
+      std::vector<char>().swap(a.blocks);
+      continue;
+    }
+    fill(a, data);
+    uint64_t size = data.size();
+    fwrite(&size, sizeof(size), 1, file);
+    if (size)
+      fwrite(&data[0], 1, size, file);
+  }
+  fwrite(tail.c_str(), 1, tail.size(), file);
+  PCU_ALWAYS_ASSERT(!ferror(file));
+  fclose(file);
+  return head.size() + offset + tail.size();
+}
+
+void writeRawVtkFiles(const char* prefix, Mesh* m,
+    std::vector<std::string> writeFields, int compression,
+    bool writeFloat32, int cellDim)
+{
+  if (cellDim == -1) cellDim = m->getDimension();
+  PCU_ALWAYS_ASSERT(0 <= compression && compression <= 9);
+  double t0 = PCU_Time();
+  Numbering* n = numberOverlapNodes(m,"apf_vtk_number");
+  m->removeNumbering(n);
+  RawVtuWriter writer(n, writeFields, compression, writeFloat32, cellDim);
+  if (!PCU_Comm_Self())
+  {
+    safe_mkdir(prefix);
+    makeVtuSubdirectories(prefix, PCU_Comm_Peers());
+    writer.writePvtu(prefix);
+  }
+  PCU_Barrier();
+  double t1 = PCU_Time();
+  size_t bytes = writer.writeVtu(prefix);
+  double t2 = PCU_Time();
+  delete n;
+  double rate = bytes / (t2 - t1);
+  double minRate = PCU_Min_Double(rate);
+  double maxRate = PCU_Max_Double(rate);
+  long total = PCU_Add_Long(bytes);
+  double t3 = PCU_Time();
+  if (!PCU_Comm_Self())
+  {
+    lion_oprint(1,"raw vtk files %s: %ld bytes written in %f seconds\n",
+        prefix, total, t3 - t0);
+    lion_oprint(1,"raw vtk pieces: %.3e to %.3e bytes per second per part\n",
+        minRate, maxRate);
+  }
+}
+
+void writeRawVtkFiles(const char* prefix, Mesh* m, int compression,
+    bool writeFloat32, int cellDim)
+{
+  std::vector<std::string> writeFields = populateWriteFields(m);
+  writeRawVtkFiles(prefix, m, writeFields, compression, writeFloat32,
+      cellDim);
+}
+
 }
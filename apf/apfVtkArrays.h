@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APFVTKARRAYS_H
+#define APFVTKARRAYS_H
+
+#include "apfNumbering.h"
+#include "apfNumberingClass.h"
+#include <string>
+#include <vector>
+
+namespace apf {
+
+/* output types past the apf::Mesh scalar types */
+enum { RAW_FLOAT32 = 3, RAW_UINT8 = 4 };
+
+size_t getRawTypeSize(int type);
+
+/* where the values of an array come from */
+enum
+{
+  RAW_NODAL,
+  RAW_IP,
+  RAW_CONNECTIVITY,
+  RAW_OFFSETS,
+  RAW_TYPES,
+  RAW_PARTS
+};
+
+struct RawArray
+{
+  std::string name;
+  int source;
+  int type;
+  int components;
+  FieldBase* field;
+  int point;
+  size_t values;
+  /* bytes in the appended data, including the header */
+  size_t bytes;
+  /* the compressed header and blocks, when compressing */
+  std::vector<char> blocks;
+};
+
+/* the binary arrays of one piece of VTK output: the points,
+   the cells, the selected point and cell data and the part ids.
+   Each array is filled on demand, so only one needs to be in
+   memory at a time. */
+class RawArrays
+{
+  public:
+    RawArrays(Numbering* n,
+        std::vector<std::string> const& writeFields,
+        bool writeFloat32,
+        int cellDim);
+    /* fill (out) with the bytes of an array, connectivity with
+       the numbers of the nodes in this piece and offsets with
+       the end of each cell in connectivity, as in .vtu files */
+    void fill(RawArray& a, std::vector<char>& out);
+  protected:
+    void addArray(std::string const& name, int source, int type,
+        int components, FieldBase* f, int point, size_t values);
+    void addField(FieldBase* f, int source);
+    void addFields(std::vector<std::string> const& writeFields, int source);
+    template <class T, class O>
+    void fillField(RawArray& a, O* out);
+    Mesh* mesh;
+    Numbering* numbering;
+    bool writeFloat32;
+    int cellDim;
+    size_t cells;
+    DynamicArray<Node> nodes;
+    std::vector<RawArray> arrays;
+    /* arrays[0] holds the points and arrays[1..3] the cells,
+       then point data starts at pointData and cell data
+       at cellData */
+    size_t pointData;
+    size_t cellData;
+};
+
+std::vector<std::string> populateWriteFields(Mesh* m);
+
+}
+
+#endif
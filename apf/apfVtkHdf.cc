@@ -0,0 +1,367 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apf.h"
+#include "apfMesh.h"
+#include "apfVtkArrays.h"
+#include <PCU.h>
+#include <pcu_util.h>
+#include <lionPrint.h>
+#include <hdf5.h>
+#include <cstring>
+
+namespace apf {
+
+/* The VTKHDF UnstructuredGrid layout stores each part as one piece:
+   the per-piece counts are in NumberOfPoints, NumberOfCells and
+   NumberOfConnectivityIds, and the arrays of all pieces are
+   concatenated in part order. Connectivity holds the point numbers
+   within each piece, and each piece has NumberOfCells + 1 offsets
+   starting at zero. */
+
+static void check(herr_t err, const char* what)
+{
+  if (err < 0)
+  {
+    lion_eprint(1, "apf::writeVtkHdfFiles: HDF5 %s failed\n", what);
+    fail("HDF5 error\n");
+  }
+}
+
+static hid_t checkId(hid_t id, const char* what)
+{
+  check(id < 0 ? -1 : 0, what);
+  return id;
+}
+
+static hid_t getHdfType(int type)
+{
+  switch (type)
+  {
+    case Mesh::DOUBLE:
+      return H5T_NATIVE_DOUBLE;
+    case RAW_FLOAT32:
+      return H5T_NATIVE_FLOAT;
+    case Mesh::INT:
+      return H5T_NATIVE_INT;
+    case Mesh::LONG:
+      return H5T_NATIVE_LONG;
+    case RAW_UINT8:
+      return H5T_NATIVE_UINT8;
+  }
+  fail("apf::writeVtkHdfFiles: bad array type\n");
+}
+
+/* the sizes of this part in one dataset and of all parts */
+struct HdfSlab
+{
+  std::string path;
+  hid_t type;
+  int components;
+  long start;
+  long rows;
+  long total;
+};
+
+/* the first index of this part and the sum over all parts */
+struct HdfCount
+{
+  void init(long n)
+  {
+    count = n;
+    start = PCU_Exscan_Long(n);
+    total = PCU_Add_Long(n);
+  }
+  long count;
+  long start;
+  long total;
+};
+
+class VtkHdfWriter : public RawArrays
+{
+  public:
+    VtkHdfWriter(Numbering* n,
+        std::vector<std::string> const& writeFields,
+        int cellDim);
+    /* returns the number of bytes written by this part */
+    long write(const char* fileName);
+  private:
+    void getSlab(size_t i, HdfSlab& s);
+    void getCountSlab(const char* name, HdfSlab& s);
+    void create(hid_t file);
+    long writePiece(hid_t file, hid_t transfer);
+    HdfCount points;
+    HdfCount cellCount;
+    HdfCount ids;
+};
+
+VtkHdfWriter::VtkHdfWriter(Numbering* n,
+    std::vector<std::string> const& writeFields,
+    int d):
+  RawArrays(n, writeFields, false, d)
+{
+  points.init(nodes.getSize());
+  cellCount.init(cells);
+  ids.init(arrays[1].values);
+}
+
+static void setSlab(HdfSlab& s, std::string const& path, hid_t type,
+    int components, HdfCount const& c)
+{
+  s.path = path;
+  s.type = type;
+  s.components = components;
+  s.start = c.start;
+  s.rows = c.count;
+  s.total = c.total;
+}
+
+void VtkHdfWriter::getSlab(size_t i, HdfSlab& s)
+{
+  RawArray& a = arrays[i];
+  hid_t type = getHdfType(a.type);
+  if (i == 0)
+    return setSlab(s, "/VTKHDF/Points", type, a.components, points);
+  if (a.source == RAW_CONNECTIVITY)
+    return setSlab(s, "/VTKHDF/Connectivity", H5T_NATIVE_LONG, 1, ids);
+  if (a.source == RAW_OFFSETS)
+  {
+    /* one more offset per piece */
+    setSlab(s, "/VTKHDF/Offsets", H5T_NATIVE_LONG, 1, cellCount);
+    s.start += PCU_Comm_Self();
+    s.rows += 1;
+    s.total += PCU_Comm_Peers();
+    return;
+  }
+  if (a.source == RAW_TYPES)
+    return setSlab(s, "/VTKHDF/Types", type, 1, cellCount);
+  if (i < cellData)
+    return setSlab(s, "/VTKHDF/PointData/" + a.name, type, a.components,
+        points);
+  setSlab(s, "/VTKHDF/CellData/" + a.name, type, a.components, cellCount);
+}
+
+void VtkHdfWriter::getCountSlab(const char* name, HdfSlab& s)
+{
+  s.path = std::string("/VTKHDF/") + name;
+  s.type = H5T_NATIVE_LONG;
+  s.components = 1;
+  s.start = PCU_Comm_Self();
+  s.rows = 1;
+  s.total = PCU_Comm_Peers();
+}
+
+static void createSet(hid_t file, HdfSlab const& s)
+{
+  hsize_t dims[2] = {hsize_t(s.total), hsize_t(s.components)};
+  int rank = s.components > 1 ? 2 : 1;
+  hid_t space = checkId(H5Screate_simple(rank, dims, 0), "H5Screate");
+  hid_t set = checkId(H5Dcreate2(file, s.path.c_str(), s.type, space,
+        H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), "H5Dcreate");
+  check(H5Dclose(set), "H5Dclose");
+  check(H5Sclose(space), "H5Sclose");
+}
+
+static void createGroup(hid_t file, const char* path)
+{
+  hid_t group = checkId(H5Gcreate2(file, path,
+        H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), "H5Gcreate");
+  check(H5Gclose(group), "H5Gclose");
+}
+
+static void writeAttributes(hid_t file)
+{
+  hid_t group = checkId(H5Gopen2(file, "/VTKHDF", H5P_DEFAULT), "H5Gopen");
+  long version[2] = {1, 0};
+  hsize_t two = 2;
+  hid_t space = checkId(H5Screate_simple(1, &two, 0), "H5Screate");
+  hid_t attr = checkId(H5Acreate2(group, "Version", H5T_NATIVE_LONG, space,
+        H5P_DEFAULT, H5P_DEFAULT), "H5Acreate");
+  check(H5Awrite(attr, H5T_NATIVE_LONG, version), "H5Awrite");
+  check(H5Aclose(attr), "H5Aclose");
+  check(H5Sclose(space), "H5Sclose");
+  const char* type = "UnstructuredGrid";
+  hid_t string = checkId(H5Tcopy(H5T_C_S1), "H5Tcopy");
+  check(H5Tset_size(string, strlen(type)), "H5Tset_size");
+  check(H5Tset_strpad(string, H5T_STR_NULLPAD), "H5Tset_strpad");
+  space = checkId(H5Screate(H5S_SCALAR), "H5Screate");
+  attr = checkId(H5Acreate2(group, "Type", string, space,
+        H5P_DEFAULT, H5P_DEFAULT), "H5Acreate");
+  check(H5Awrite(attr, string, type), "H5Awrite");
+  check(H5Aclose(attr), "H5Aclose");
+  check(H5Sclose(space), "H5Sclose");
+  check(H5Tclose(string), "H5Tclose");
+  check(H5Gclose(group), "H5Gclose");
+}
+
+/* the groups, attributes and datasets, all sized for every part */
+void VtkHdfWriter::create(hid_t file)
+{
+  createGroup(file, "/VTKHDF");
+  createGroup(file, "/VTKHDF/PointData");
+  createGroup(file, "/VTKHDF/CellData");
+  writeAttributes(file);
+  HdfSlab s;
+  const char* counts[3] =
+    {"NumberOfPoints", "NumberOfCells", "NumberOfConnectivityIds"};
+  for (int i = 0; i < 3; ++i)
+  {
+    getCountSlab(counts[i], s);
+    createSet(file, s);
+  }
+  for (size_t i = 0; i < arrays.size(); ++i)
+  {
+    getSlab(i, s);
+    createSet(file, s);
+  }
+}
+
+/* returns the number of bytes written by this part */
+static long writeSlab(hid_t file, HdfSlab const& s, void const* data,
+    hid_t transfer)
+{
+  hid_t set = checkId(H5Dopen2(file, s.path.c_str(), H5P_DEFAULT),
+      "H5Dopen");
+  hid_t fileSpace = checkId(H5Dget_space(set), "H5Dget_space");
+  hsize_t start[2] = {hsize_t(s.start), 0};
+  hsize_t count[2] = {hsize_t(s.rows), hsize_t(s.components)};
+  int rank = s.components > 1 ? 2 : 1;
+  hid_t memSpace = checkId(H5Screate_simple(rank, count, 0), "H5Screate");
+  if (s.rows)
+    check(H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, start, 0, count, 0),
+        "H5Sselect_hyperslab");
+  else
+  {
+    /* parts without values still take part in collective writes */
+    check(H5Sselect_none(fileSpace), "H5Sselect_none");
+    check(H5Sselect_none(memSpace), "H5Sselect_none");
+  }
+  check(H5Dwrite(set, s.type, memSpace, fileSpace, transfer, data),
+      "H5Dwrite");
+  check(H5Sclose(memSpace), "H5Sclose");
+  check(H5Sclose(fileSpace), "H5Sclose");
+  check(H5Dclose(set), "H5Dclose");
+  return s.rows * s.components * H5Tget_size(s.type);
+}
+
+long VtkHdfWriter::writePiece(hid_t file, hid_t transfer)
+{
+  long bytes = 0;
+  HdfSlab s;
+  long counts[3] = {points.count, cellCount.count, ids.count};
+  const char* names[3] =
+    {"NumberOfPoints", "NumberOfCells", "NumberOfConnectivityIds"};
+  for (int i = 0; i < 3; ++i)
+  {
+    getCountSlab(names[i], s);
+    bytes += writeSlab(file, s, &counts[i], transfer);
+  }
+  std::vector<char> data;
+  std::vector<long> longs;
+  for (size_t i = 0; i < arrays.size(); ++i)
+  {
+    RawArray& a = arrays[i];
+    getSlab(i, s);
+    fill(a, data);
+    void const* p = data.empty() ? 0 : &data[0];
+    if (a.source == RAW_CONNECTIVITY || a.source == RAW_OFFSETS)
+    {
+      /* VTK ids are 64 bits, and offsets start at zero */
+      int const* ints = static_cast<int const*>(p);
+      longs.clear();
+      if (a.source == RAW_OFFSETS)
+        longs.push_back(0);
+      longs.insert(longs.end(), ints, ints + a.values);
+      p = longs.empty() ? 0 : &longs[0];
+    }
+    bytes += writeSlab(file, s, p, transfer);
+  }
+  return bytes;
+}
+
+long VtkHdfWriter::write(const char* fileName)
+{
+  long bytes = 0;
+#ifdef H5_HAVE_PARALLEL
+  hid_t access = checkId(H5Pcreate(H5P_FILE_ACCESS), "H5Pcreate");
+  check(H5Pset_fapl_mpio(access, PCU_Get_Comm(), MPI_INFO_NULL),
+      "H5Pset_fapl_mpio");
+  hid_t file = checkId(H5Fcreate(fileName, H5F_ACC_TRUNC,
+        H5P_DEFAULT, access), "H5Fcreate");
+  check(H5Pclose(access), "H5Pclose");
+  create(file);
+  hid_t transfer = checkId(H5Pcreate(H5P_DATASET_XFER), "H5Pcreate");
+  check(H5Pset_dxpl_mpio(transfer, H5FD_MPIO_COLLECTIVE),
+      "H5Pset_dxpl_mpio");
+  bytes = writePiece(file, transfer);
+  check(H5Pclose(transfer), "H5Pclose");
+  check(H5Fclose(file), "H5Fclose");
+#else
+  /* without MPI-IO in HDF5 the parts take turns writing, each one
+     reopening the file after the barrier of the one before it.
+     that is fine for a few parts but the time grows with their
+     number, so say so once */
+  static bool warned = false;
+  if (!warned && !PCU_Comm_Self() && PCU_Comm_Peers() > 1)
+    lion_eprint(1,"APF warning: HDF5 has no MPI-IO support, so the %d parts "
+        "write VTKHDF files one at a time\n", PCU_Comm_Peers());
+  warned = true;
+  if (!PCU_Comm_Self())
+  {
+    hid_t file = checkId(H5Fcreate(fileName, H5F_ACC_TRUNC,
+          H5P_DEFAULT, H5P_DEFAULT), "H5Fcreate");
+    create(file);
+    check(H5Fclose(file), "H5Fclose");
+  }
+  for (int i = 0; i < PCU_Comm_Peers(); ++i)
+  {
+    PCU_Barrier();
+    if (i != PCU_Comm_Self())
+      continue;
+    hid_t file = checkId(H5Fopen(fileName, H5F_ACC_RDWR, H5P_DEFAULT),
+        "H5Fopen");
+    bytes = writePiece(file, H5P_DEFAULT);
+    check(H5Fclose(file), "H5Fclose");
+  }
+  PCU_Barrier();
+#endif
+  return bytes;
+}
+
+void writeVtkHdfFiles(
+    const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    int cellDim)
+{
+  if (cellDim == -1) cellDim = m->getDimension();
+  double t0 = PCU_Time();
+  Numbering* n = numberOverlapNodes(m,"apf_vtk_number");
+  m->removeNumbering(n);
+  std::string fileName = std::string(prefix) + ".vtkhdf";
+  long bytes;
+  {
+    VtkHdfWriter writer(n, writeFields, cellDim);
+    bytes = writer.write(fileName.c_str());
+  }
+  delete n;
+  bytes = PCU_Add_Long(bytes);
+  double t1 = PCU_Time();
+  if (!PCU_Comm_Self())
+  {
+    lion_oprint(1,"vtkhdf file %s: %ld bytes written in %f seconds\n",
+        fileName.c_str(), bytes, t1 - t0);
+  }
+}
+
+void writeVtkHdfFiles(const char* prefix, Mesh* m, int cellDim)
+{
+  std::vector<std::string> writeFields = populateWriteFields(m);
+  writeVtkHdfFiles(prefix, m, writeFields, cellDim);
+}
+
+}
@@ -11,6 +11,8 @@ set(APF_SOURCES
   apf.cc
   apfCavityOp.cc
   apfElement.cc
+  apfElementBatch.cc
+  apfShapeTable.cc
   apfField.cc
   apfFieldOf.cc
   apfGradientByVolume.cc
@@ -37,6 +39,7 @@ set(APF_SOURCES
   apfAdjReorder.cc
   apfVtk.cc
   apfFieldData.cc
+  apfExchange.cc
   apfTagData.cc
   apfCoordData.cc
   apfArrayData.cc
@@ -49,7 +52,13 @@ set(APF_SOURCES
   apfBoundaryToElementXi.cc
   apfSimplexAngleCalcs.cc
   apfFile.cc
+  apfThreads.cc
 )
+if(APF_VTKHDF)
+  set(APF_SOURCES ${APF_SOURCES} apfVtkHdf.cc)
+else()
+  set(APF_SOURCES ${APF_SOURCES} apfNoVtkHdf.cc)
+endif()
 
 set(APF_HEADERS
   apf.h
@@ -73,6 +82,10 @@ set(APF_HEADERS
   apfField.h
   apfFieldData.h
   apfNumberingClass.h
+  apfThreads.h
+  apfExchange.h
+  apfElementBatch.h
+  apfShapeTable.h
 )
 
 set(APF_SOURCES
@@ -94,6 +107,17 @@ set(APF_HEADERS
     ../mth/mthAD.h
    )
 
+# apf::parallelFor runs on POSIX threads
+find_package(Threads REQUIRED)
+set(APF_IMPORTED_LIBS ${CMAKE_THREAD_LIBS_INIT})
+
+# VTKHDF output goes through HDF5
+if(APF_VTKHDF)
+  find_package(HDF5 REQUIRED COMPONENTS C)
+  set(APF_INCLUDE_DIRS ${APF_INCLUDE_DIRS} ${HDF5_INCLUDE_DIRS})
+  set(APF_IMPORTED_LIBS ${APF_IMPORTED_LIBS} ${HDF5_C_LIBRARIES})
+endif()
+
 # THIS IS WHERE TRIBITS GETS HEADERS
 include_directories(${APF_INCLUDE_DIRS})
 
@@ -101,6 +125,7 @@ include_directories(${APF_INCLUDE_DIRS})
 tribits_add_library(
    apf
    HEADERS ${APF_HEADERS}
-   SOURCES ${APF_SOURCES})
+   SOURCES ${APF_SOURCES}
+   IMPORTEDLIBS ${APF_IMPORTED_LIBS})
 
 tribits_package_postprocess()
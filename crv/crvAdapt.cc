@@ -15,6 +15,7 @@
 #include <maSnap.h>
 #include <maStats.h>
 #include <maLayer.h>
+#include <maProfile.h>
 #include <PCU.h>
 #include <pcu_util.h>
 
@@ -212,6 +213,7 @@ void adapt(ma::Input* in)
   for (int i=0; i < in->maximumIterations; ++i)
   {
     ma::print("iteration %d",i);
+    ma::setIteration(a,i);
     ma::coarsen(a);
     ma::midBalance(a);
     crv::refine(a);
@@ -219,6 +221,7 @@ void adapt(ma::Input* in)
     flagCleaner(a); // all true-flags must be false before using markEntities
     fixCrvElementShapes(a);
   }
+  ma::setIteration(a,-1);
 
   allowSplitCollapseOutsideLayer(a);
 
@@ -230,6 +233,8 @@ void adapt(ma::Input* in)
   cleanupLayer(a);
   ma::printQuality(a);
   ma::postBalance(a);
+  if (in->profileFile && in->profileFile[0])
+    ma::writeProfile(a,in->profileFile);
   double t1 = PCU_Time();
   ma::print("mesh adapted in %f seconds",t1-t0);
   apf::printStats(a->mesh);
@@ -103,6 +103,18 @@ void gmi_eval(struct gmi_model* m, struct gmi_ent* e,
   m->ops->eval(m, e, p, x);
 }
 
+void gmi_eval_many(struct gmi_model* m, int n, struct gmi_ent* const e[],
+    double const p[][2], double x[][3])
+{
+  int i;
+  if (m->ops->eval_many) {
+    m->ops->eval_many(m, n, e, p, x);
+    return;
+  }
+  for (i = 0; i < n; ++i)
+    m->ops->eval(m, e[i], p[i], x[i]);
+}
+
 void gmi_reparam(struct gmi_model* m, struct gmi_ent* from,
     double const from_p[2], struct gmi_ent* to, double to_p[2])
 {
@@ -106,6 +106,11 @@ struct gmi_model_ops {
   int (*is_discrete_ent)(struct gmi_model* m, struct gmi_ent* e);
   /** \brief implement gmi_destroy */
   void (*destroy)(struct gmi_model* m);
+  /** \brief implement gmi_eval_many
+   \details if omitted then gmi_eval_many calls eval for each point.
+   This comes last so that models filling the ops in order are unaffected */
+  void (*eval_many)(struct gmi_model* m, int n, struct gmi_ent* const e[],
+      double const p[][2], double x[][3]);
 };
 
 /** \brief the basic structure for all GMI models */
@@ -159,6 +164,12 @@ int gmi_has_normal(struct gmi_model* m);
   \param x the resulting point in space */
 void gmi_eval(struct gmi_model* m, struct gmi_ent* e,
     double const p[2], double x[3]);
+/** \brief evaluate (n) points at once, see gmi_eval
+  \details point (i) is at p[i] on model entity e[i]. models can
+            implement this to avoid a call per point when many
+            are evaluated together, such as while snapping */
+void gmi_eval_many(struct gmi_model* m, int n, struct gmi_ent* const e[],
+    double const p[][2], double x[][3]);
 /** \brief re-parameterize from one model entity to another
   \param from the model entity to start from
   \param from_p the parametric coordinates on entity (from),
@@ -106,6 +106,32 @@ static void eval(struct gmi_model* m, struct gmi_ent* e,
   (*f)(p, x, u);
 }
 
+/* consecutive points are usually on the same model entity,
+   so its function is only looked up when the entity changes */
+static void eval_many(struct gmi_model* m, int n, struct gmi_ent* const e[],
+    double const p[][2], double x[][3])
+{
+  struct gmi_analytic* m2;
+  struct agm_ent a;
+  struct gmi_ent* last;
+  void* u;
+  gmi_analytic_fun f;
+  int i;
+  m2 = to_model(m);
+  last = 0;
+  u = 0;
+  f = 0;
+  for (i = 0; i < n; ++i) {
+    if (!i || e[i] != last) {
+      a = agm_from_gmi(e[i]);
+      u = *(data_of(m2, a));
+      f = *(f_of(m2, a));
+      last = e[i];
+    }
+    (*f)(p[i], x[i], u);
+  }
+}
+
 static void reparam_across(struct gmi_analytic* m, struct agm_use u,
     double const from_p[2], double to_p[2])
 {
@@ -327,7 +353,8 @@ static struct gmi_model_ops ops = {
   .first_derivative = first_derivative,
   .bbox = bbox,
   .is_point_in_region = is_point_in_region,
-  .destroy  = gmi_base_destroy
+  .destroy  = gmi_base_destroy,
+  .eval_many = eval_many
 };
 
 struct gmi_model* gmi_make_analytic(void)
@@ -8,6 +8,10 @@ extern const bool can_compress;
 void compress(void* dest, unsigned long& destLen,
     const void* source, unsigned long sourceLen);
 
+/* the same with a zlib level from 1 (fastest) to 9 (smallest) */
+void compress(void* dest, unsigned long& destLen,
+    const void* source, unsigned long sourceLen, int level);
+
 unsigned long compressBound(unsigned long sourceLen);
 
 }
@@ -16,6 +16,17 @@ void compress(void* dest, unsigned long& destLen,
   abort();
 }
 
+void compress(void* dest, unsigned long& destLen,
+    const void* source, unsigned long sourceLen, int level)
+{
+  (void) dest;
+  (void) destLen;
+  (void) source;
+  (void) sourceLen;
+  (void) level;
+  abort();
+}
+
 unsigned long compressBound(unsigned long sourceLen)
 {
 	(void) sourceLen;
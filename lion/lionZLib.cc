@@ -12,6 +12,12 @@ void compress(void* dest, unsigned long& destLen,
   ::compress((Bytef*)dest, &destLen, (const Bytef*)source, sourceLen);
 }
 
+void compress(void* dest, unsigned long& destLen,
+    const void* source, unsigned long sourceLen, int level)
+{
+  ::compress2((Bytef*)dest, &destLen, (const Bytef*)source, sourceLen, level);
+}
+
 unsigned long compressBound(unsigned long sourceLen)
 {
 	return ::compressBound(sourceLen);
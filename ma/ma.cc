@@ -17,6 +17,7 @@
 #include "maBalance.h"
 #include "maLayer.h"
 #include "maDBG.h"
+#include "maProfile.h"
 #include <pcu_util.h>
 
 namespace ma {
@@ -31,18 +32,22 @@ void adapt(Input* in)
   for (int i = 0; i < in->maximumIterations; ++i)
   {
     print("iteration %d",i);
+    setIteration(a,i);
     coarsen(a);
     coarsenLayer(a);
     midBalance(a);
     refine(a);
     snap(a);
   }
+  setIteration(a,-1);
   allowSplitCollapseOutsideLayer(a);
   fixElementShapes(a);
   cleanupLayer(a);
   tetrahedronize(a);
   printQuality(a);
   postBalance(a);
+  if (in->profileFile && in->profileFile[0])
+    writeProfile(a,in->profileFile);
   Mesh* m = a->mesh;
   delete a;
   delete in;
@@ -61,6 +66,7 @@ void adaptVerbose(Input* in, bool verbose)
   for (int i = 0; i < in->maximumIterations; ++i)
   {
     print("iteration %d",i);
+    setIteration(a,i);
     coarsen(a);
     if (verbose && in->shouldCoarsen)
       ma_dbg::dumpMeshWithQualities(a,i,"after_coarsen");
@@ -76,6 +82,7 @@ void adaptVerbose(Input* in, bool verbose)
     if (verbose && in->shouldFixShape)
       ma_dbg::dumpMeshWithQualities(a,i,"after_fix");
   }
+  setIteration(a,-1);
   allowSplitCollapseOutsideLayer(a);
   if (verbose) ma_dbg::dumpMeshWithQualities(a,999,"after_final_fix");
   // The following is applied to 2D surface meshes only and has no effect
@@ -107,6 +114,8 @@ void adaptVerbose(Input* in, bool verbose)
   tetrahedronize(a);
   printQuality(a);
   postBalance(a);
+  if (in->profileFile && in->profileFile[0])
+    writeProfile(a,in->profileFile);
   Mesh* m = a->mesh;
   delete a;
   delete in;
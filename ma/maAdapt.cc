@@ -18,7 +18,9 @@
 #include "maShape.h"
 #include "maShapeHandler.h"
 #include "maLayer.h"
+#include "maProfile.h"
 #include <apf.h>
+#include <apfMDS.h>
 #include <cfloat>
 #include <pcu_util.h>
 #include <stdarg.h>
@@ -29,17 +31,20 @@ Adapt::Adapt(Input* in)
 {
   input = in;
   mesh = in->mesh;
+  mdsTags = apf::isMdsMesh(mesh);
   setupFlags(this);
   setupQualityCache(this);
   deleteCallback = 0;
   buildCallback = 0;
   sizeField = in->sizeField;
+  sizeField->setClosedFormEdges(in->shouldMeasureEdgesInClosedForm);
   solutionTransfer = in->solutionTransfer;
   refine = new Refine(this);
   if (in->shapeHandler){
     shape = in->shapeHandler(this);
   } else
     shape = getShapeHandler(this);
+  profile = createProfile(this);
   if (in->shouldCoarsen)
     coarsensLeft = in->maximumIterations;
   else
@@ -56,6 +61,7 @@ Adapt::~Adapt()
   clearQualityCache(this);
   delete refine;
   delete shape;
+  destroyProfile(profile);
 }
 
 void setupFlags(Adapt* a)
@@ -69,6 +75,10 @@ void clearFlags(Adapt* a)
   Entity* e;
   for (int d=0; d <= 3; ++d)
   {
+    if (a->mdsTags) {
+      apf::removeMdsTag(m, a->flagsTag, d);
+      continue;
+    }
     Iterator* it = m->begin(d);
     while ((e = m->iterate(it)))
       if (m->hasTag(e,a->flagsTag))
@@ -80,6 +90,8 @@ void clearFlags(Adapt* a)
 
 int getFlags(Adapt* a, Entity* e)
 {
+  if (a->mdsTags)
+    return apf::getMdsIntTag(a->flagsTag, e);
   Mesh* m = a->mesh;
   if ( ! m->hasTag(e,a->flagsTag))
     return 0; //we assume 0 is the default value for all flags
@@ -90,7 +102,10 @@ int getFlags(Adapt* a, Entity* e)
 
 void setFlags(Adapt* a, Entity* e, int flags)
 {
-  a->mesh->setIntTag(e,a->flagsTag,&flags);
+  if (a->mdsTags)
+    apf::setMdsIntTag(a->mesh, a->flagsTag, e, flags);
+  else
+    a->mesh->setIntTag(e,a->flagsTag,&flags);
 }
 
 bool getFlag(Adapt* a, Entity* e, int flag)
@@ -141,6 +156,10 @@ void clearFlagMatched(Adapt* a, Entity* e, int flag)
 void clearFlagFromDimension(Adapt* a, int flag, int dimension)
 {
   Mesh* m = a->mesh;
+  if (a->mdsTags) {
+    apf::clearMdsIntTagBits(m, a->flagsTag, dimension, flag);
+    return;
+  }
   Iterator* it = m->begin(dimension);
   Entity* e;
   while ((e = m->iterate(it)))
@@ -160,6 +179,10 @@ void clearQualityCache(Adapt* a)
   // only faces and regions can have the quality tag
   for (int d=2; d <= 3; ++d)
   {
+    if (a->mdsTags) {
+      apf::removeMdsTag(m, a->qualityCache, d);
+      continue;
+    }
     Iterator* it = m->begin(d);
     while ((e = m->iterate(it)))
       if (m->hasTag(e,a->qualityCache))
@@ -169,15 +192,27 @@ void clearQualityCache(Adapt* a)
   m->destroyTag(a->qualityCache);
 }
 
+bool hasCachedQuality(Adapt* a, Entity* e)
+{
+  double qual;
+  if (a->mdsTags)
+    return apf::getMdsDoubleTag(a->qualityCache, e, &qual);
+  return a->mesh->hasTag(e,a->qualityCache);
+}
+
 double getCachedQuality(Adapt* a, Entity* e)
 {
   Mesh* m = a->mesh;
   int type = m->getType(e);
   int ed = apf::Mesh::typeDimension[type];
   PCU_ALWAYS_ASSERT(ed == 2 || ed == 3);
+  double qual = 0.0; //we assume 0.0 is the default value for all qualities
+  if (a->mdsTags) {
+    apf::getMdsDoubleTag(a->qualityCache, e, &qual);
+    return qual;
+  }
   if ( ! m->hasTag(e,a->qualityCache))
-    return 0.0; //we assume 0.0 is the default value for all qualities
-  double qual;
+    return qual;
   m->getDoubleTag(e,a->qualityCache,&qual);
   return qual;
 }
@@ -188,7 +223,10 @@ void setCachedQuality(Adapt* a, Entity* e, double q)
   int type = m->getType(e);
   int ed = apf::Mesh::typeDimension[type];
   PCU_ALWAYS_ASSERT(ed == 2 || ed == 3);
-  m->setDoubleTag(e,a->qualityCache,&q);
+  if (a->mdsTags)
+    apf::setMdsDoubleTag(m, a->qualityCache, e, q);
+  else
+    m->setDoubleTag(e,a->qualityCache,&q);
 }
 
 void destroyElement(Adapt* a, Entity* e)
@@ -40,6 +40,7 @@ class DeleteCallback;
 class SolutionTransfer;
 class Refine;
 class ShapeHandler;
+class Profile;
 
 class Adapt
 {
@@ -50,12 +51,14 @@ class Adapt
     Mesh* mesh;
     Tag* flagsTag;
     Tag* qualityCache; // to avoid repeated quality computations
+    bool mdsTags; // reach the two tags above through apf::getMdsIntTag etc.
     DeleteCallback* deleteCallback;
     apf::BuildCallback* buildCallback;
     SizeField* sizeField;
     SolutionTransfer* solutionTransfer;
     Refine* refine;
     ShapeHandler* shape;
+    Profile* profile;
     int coarsensLeft;
     int refinesLeft;
     bool hasLayer;
@@ -78,6 +81,7 @@ void clearFlagFromDimension(Adapt* a, int flag, int dimension);
 
 void setupQualityCache(Adapt* a);
 void clearQualityCache(Adapt* a);
+bool hasCachedQuality(Adapt* a, Entity* e);
 double getCachedQuality(Adapt* a, Entity* e);
 void   setCachedQuality(Adapt* a, Entity* e, double q);
 
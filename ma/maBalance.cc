@@ -1,6 +1,7 @@
 #include <PCU.h>
 #include "maBalance.h"
 #include "maAdapt.h"
+#include "maProfile.h"
 #include <parma.h>
 #include <apfZoltan.h>
 
@@ -125,6 +126,7 @@ void preBalance(Adapt* a)
 {
   if (PCU_Comm_Peers()==1)
     return;
+  Stage stage(a, "preBalance");
   Input* in = a->input;
   if (in->shouldRunPreZoltan)
     runZoltan(a);
@@ -138,6 +140,7 @@ void midBalance(Adapt* a)
 {
   if (PCU_Comm_Peers()==1)
     return;
+  Stage stage(a, "midBalance");
   Input* in = a->input;
   if (in->shouldRunMidZoltan)
     runZoltan(a);
@@ -149,6 +152,7 @@ void postBalance(Adapt* a)
 {
   if (PCU_Comm_Peers()==1)
     return;
+  Stage stage(a, "postBalance");
   Input* in = a->input;
   if (in->shouldRunPostZoltan)
     runZoltan(a);
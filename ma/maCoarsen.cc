@@ -10,10 +10,16 @@
 #include <PCU.h>
 #include "maCoarsen.h"
 #include "maAdapt.h"
+#include "maProfile.h"
 #include "maCollapse.h"
 #include "maMatchedCollapse.h"
 #include "maOperator.h"
+#include "maShape.h"
+#include <apfShape.h>
+#include <apfThreads.h>
 #include <pcu_util.h>
+#include <cfloat>
+#include <vector>
 
 namespace ma {
 
@@ -158,6 +164,378 @@ int collapseAllEdges(Adapt* a, int modelDimension)
   return collapser.successCount;
 }
 
+/* Interior collapses of linear tets can have their quality
+   computed away from the mesh.
+   The vertices that may collapse are colored so that no two
+   vertices of one color are adjacent.
+   Collapsing a vertex only replaces the tets around it,
+   so within one color the tets around every vertex are the same
+   before and after the others collapse.
+   The coordinates and size field transforms of those tets are
+   copied into a batch, the qualities are computed on threads,
+   and the collapses that pass are then applied one at a time,
+   since the mesh itself can't be modified concurrently.
+   Since collapses of earlier colors add edges, adjacency within a
+   color is checked again when its batch is gathered.
+   Anything this leaves flagged is handled by collapseAllEdges. */
+
+static bool canCollapseWithThreads(Adapt* a)
+{
+  Mesh* m = a->mesh;
+  if (m->getDimension() != 3)
+    return false;
+  if (m->getShape()->getOrder() != 1)
+    return false;
+  if (a->input->shapeHandler)
+    return false;
+  if (a->hasLayer || m->hasMatching())
+    return false;
+  return true;
+}
+
+static bool isLocal(Mesh* m, Entity* e)
+{
+  return ( ! m->isShared(e)) &&
+         ( ! m->isGhost(e)) &&
+         ( ! m->isGhosted(e));
+}
+
+/* the edges along which v can collapse in this pass,
+   which are only the ones classified like v, so that the
+   classification checks done earlier hold in this direction */
+static bool getEdgesToCollapse(Adapt* a, Entity* v, int modelDimension,
+    std::vector<Entity*>& edges)
+{
+  edges.clear();
+  Mesh* m = a->mesh;
+  if (( ! getFlag(a,v,COLLAPSE)) || ( ! isLocal(m,v)))
+    return false;
+  Model* c = m->toModel(v);
+  apf::Up up;
+  m->getUp(v,up);
+  for (int i = 0; i < up.n; ++i) {
+    Entity* e = up.e[i];
+    if (( ! getFlag(a,e,COLLAPSE)) || getFlag(a,e,DONT_COLLAPSE))
+      continue;
+    if (m->toModel(e) != c)
+      continue;
+    if (m->getModelType(c) != modelDimension)
+      continue;
+    if ( ! isLocal(m,getEdgeVertOppositeVert(m,e,v)))
+      continue;
+    edges.push_back(e);
+  }
+  if (edges.empty())
+    return false;
+  Upward elements;
+  m->getAdjacent(v,3,elements);
+  for (size_t i = 0; i < elements.getSize(); ++i)
+    if (m->getType(elements[i]) != apf::Mesh::TET)
+      return false;
+  return true;
+}
+
+typedef std::vector<std::vector<Entity*> > Colors;
+
+/* greedy coloring in iteration order */
+static void colorVertices(Adapt* a, int modelDimension, Colors& colors)
+{
+  Mesh* m = a->mesh;
+  Tag* tag = m->createIntTag("ma_collapse_color",1);
+  std::vector<Entity*> edges;
+  std::vector<bool> used;
+  Iterator* it = m->begin(0);
+  Entity* v;
+  while ((v = m->iterate(it))) {
+    if ( ! getEdgesToCollapse(a,v,modelDimension,edges))
+      continue;
+    used.assign(colors.size(),false);
+    apf::Up up;
+    m->getUp(v,up);
+    for (int i = 0; i < up.n; ++i) {
+      Entity* o = getEdgeVertOppositeVert(m,up.e[i],v);
+      if (m->hasTag(o,tag)) {
+        int c;
+        m->getIntTag(o,tag,&c);
+        used[c] = true;
+      }
+    }
+    int c = 0;
+    while (c < (int)used.size() && used[c])
+      ++c;
+    if (c == (int)colors.size())
+      colors.push_back(std::vector<Entity*>());
+    colors[c].push_back(v);
+    m->setIntTag(v,tag,&c);
+  }
+  m->end(it);
+  for (size_t i = 0; i < colors.size(); ++i)
+    for (size_t j = 0; j < colors[i].size(); ++j)
+      m->removeTag(colors[i][j],tag);
+  m->destroyTag(tag);
+}
+
+struct CollapseBatch
+{
+  std::vector<Entity*> vertices;
+  std::vector<int> centers;
+  /* the edges of vertex i, the points they would collapse onto,
+     and the worst quality that would leave
+     are in [firstEdge[i], firstEdge[i + 1]) */
+  std::vector<int> firstEdge;
+  std::vector<Entity*> edges;
+  std::vector<int> keepPoints;
+  std::vector<double> qualities;
+  std::vector<char> passed;
+  /* the tets around vertex i, four points each,
+     are in [firstTet[i], firstTet[i + 1]) */
+  std::vector<int> firstTet;
+  std::vector<int> tetPoints;
+  std::vector<Vector> points;
+  std::vector<Matrix> transforms;
+};
+
+class BatchGatherer
+{
+  public:
+    BatchGatherer(Adapt* a, CollapseBatch& b):
+      adapt(a),
+      batch(b)
+    {
+      tag = a->mesh->createIntTag("ma_collapse_point",1);
+    }
+    ~BatchGatherer()
+    {
+      Mesh* m = adapt->mesh;
+      for (size_t i = 0; i < tagged.size(); ++i)
+        m->removeTag(tagged[i],tag);
+      m->destroyTag(tag);
+    }
+    int getPoint(Entity* v)
+    {
+      Mesh* m = adapt->mesh;
+      int i;
+      if (m->hasTag(v,tag)) {
+        m->getIntTag(v,tag,&i);
+        return i;
+      }
+      i = batch.points.size();
+      m->setIntTag(v,tag,&i);
+      tagged.push_back(v);
+      batch.points.push_back(getPosition(m,v));
+      /* the transform getMetricWithMaxJacobean uses */
+      apf::MeshElement* me = apf::createMeshElement(m,v);
+      Matrix Q;
+      adapt->sizeField->getTransform(me,Vector(0,0,0),Q);
+      apf::destroyMeshElement(me);
+      batch.transforms.push_back(Q);
+      isCenter.push_back(false);
+      return i;
+    }
+    /* earlier colors may have made vertices of this color adjacent,
+       those are put off to the next color */
+    bool isNextToCenter(Entity* v)
+    {
+      Mesh* m = adapt->mesh;
+      apf::Up up;
+      m->getUp(v,up);
+      for (int i = 0; i < up.n; ++i) {
+        Entity* o = getEdgeVertOppositeVert(m,up.e[i],v);
+        if ( ! m->hasTag(o,tag))
+          continue;
+        int p;
+        m->getIntTag(o,tag,&p);
+        if (isCenter[p])
+          return true;
+      }
+      return false;
+    }
+    void gather(std::vector<Entity*>& color, int modelDimension,
+        std::vector<Entity*>& deferred)
+    {
+      Mesh* m = adapt->mesh;
+      std::vector<Entity*> edges;
+      batch.firstEdge.push_back(0);
+      batch.firstTet.push_back(0);
+      for (size_t i = 0; i < color.size(); ++i) {
+        Entity* v = color[i];
+        if ( ! getEdgesToCollapse(adapt,v,modelDimension,edges))
+          continue;
+        if (isNextToCenter(v)) {
+          deferred.push_back(v);
+          continue;
+        }
+        batch.vertices.push_back(v);
+        int center = getPoint(v);
+        isCenter[center] = true;
+        batch.centers.push_back(center);
+        for (size_t j = 0; j < edges.size(); ++j) {
+          batch.edges.push_back(edges[j]);
+          batch.keepPoints.push_back(
+              getPoint(getEdgeVertOppositeVert(m,edges[j],v)));
+        }
+        batch.firstEdge.push_back(batch.edges.size());
+        Upward elements;
+        m->getAdjacent(v,3,elements);
+        for (size_t j = 0; j < elements.getSize(); ++j) {
+          Entity* tv[4];
+          m->getDownward(elements[j],0,tv);
+          for (int k = 0; k < 4; ++k)
+            batch.tetPoints.push_back(getPoint(tv[k]));
+        }
+        batch.firstTet.push_back(batch.tetPoints.size() / 4);
+      }
+      batch.qualities.assign(batch.edges.size(),0);
+      batch.passed.assign(batch.edges.size(),0);
+    }
+  private:
+    Adapt* adapt;
+    CollapseBatch& batch;
+    Tag* tag;
+    std::vector<Entity*> tagged;
+    std::vector<bool> isCenter;
+};
+
+/* the same acceptance test as Collapse::tryBothDirections
+   followed by hasWorseQuality, for one direction */
+class CollapseEvaluator : public apf::ParallelLoop
+{
+  public:
+    CollapseEvaluator(Adapt* a, CollapseBatch& b):
+      input(a->input),
+      batch(b)
+    {
+    }
+    double measure(int tet, int center, int replacement)
+    {
+      Vector x[4];
+      Matrix Q[4];
+      for (int i = 0; i < 4; ++i) {
+        int p = batch.tetPoints[tet * 4 + i];
+        if (p == center)
+          p = replacement;
+        x[i] = batch.points[p];
+        Q[i] = batch.transforms[p];
+      }
+      return measureLinearTetQuality(x,Q);
+    }
+    bool hasPoint(int tet, int p)
+    {
+      for (int i = 0; i < 4; ++i)
+        if (batch.tetPoints[tet * 4 + i] == p)
+          return true;
+      return false;
+    }
+    virtual void apply(int i, int)
+    {
+      int center = batch.centers[i];
+      int tetBegin = batch.firstTet[i];
+      int tetEnd = batch.firstTet[i + 1];
+      double qualityToBeat = input->validQuality;
+      if ( ! input->shouldForceAdaptation) {
+        double oldQuality = DBL_MAX;
+        for (int t = tetBegin; t < tetEnd; ++t)
+          oldQuality = std::min(oldQuality, measure(t,center,center));
+        qualityToBeat = std::min(input->goodQuality,
+            std::max(oldQuality,input->validQuality));
+      }
+      /* collapseAllEdges takes the first edge that passes, here they
+         are tried from the best resulting quality down, which loses
+         fewer later collapses to the order vertices are visited in */
+      int edgeBegin = batch.firstEdge[i];
+      int edgeEnd = batch.firstEdge[i + 1];
+      for (int e = edgeBegin; e < edgeEnd; ++e) {
+        int keep = batch.keepPoints[e];
+        double worst = DBL_MAX;
+        for (int t = tetBegin; t < tetEnd; ++t)
+          if ( ! hasPoint(t,keep))
+            worst = std::min(worst, measure(t,center,keep));
+        if (worst == DBL_MAX)
+          worst = -DBL_MAX;
+        batch.qualities[e] = worst;
+        for (int f = e; f > edgeBegin &&
+             batch.qualities[f] > batch.qualities[f - 1]; --f) {
+          std::swap(batch.qualities[f], batch.qualities[f - 1]);
+          std::swap(batch.edges[f], batch.edges[f - 1]);
+          std::swap(batch.keepPoints[f], batch.keepPoints[f - 1]);
+        }
+      }
+      for (int e = edgeBegin; e < edgeEnd; ++e)
+        batch.passed[e] = batch.qualities[e] >= qualityToBeat;
+    }
+  private:
+    Input* input;
+    CollapseBatch& batch;
+};
+
+static int applyBatch(Adapt* a, CollapseBatch& b)
+{
+  Mesh* m = a->mesh;
+  Collapse collapse;
+  collapse.Init(a);
+  int successCount = 0;
+  for (size_t i = 0; i < b.vertices.size(); ++i) {
+    Entity* v = b.vertices[i];
+    for (int e = b.firstEdge[i]; e < b.firstEdge[i + 1]; ++e) {
+      if ( ! getFlag(a,v,COLLAPSE))
+        break;
+      Entity* edge = b.edges[e];
+      if ( ! getFlag(a,edge,COLLAPSE))
+        continue;
+      if ( ! collapse.setEdge(edge))
+        continue;
+      if ( ! checkEdgeCollapseTopology(a,edge)) {
+        collapse.unmark();
+        continue;
+      }
+      collapse.vertToCollapse = v;
+      collapse.vertToKeep = getEdgeVertOppositeVert(m,edge,v);
+      if ( ! b.passed[e]) {
+        /* collapseAllEdges will still try the other direction */
+        if ( ! getFlag(a,collapse.vertToKeep,COLLAPSE))
+          collapse.unmark();
+        continue;
+      }
+      collapse.computeElementSets();
+      collapse.rebuildElements();
+      collapse.destroyOldElements();
+      ++successCount;
+      break;
+    }
+  }
+  return successCount;
+}
+
+int collapseEdgesWithThreads(Adapt* a, int modelDimension)
+{
+  if ( ! canCollapseWithThreads(a))
+    return 0;
+  Colors colors;
+  colorVertices(a,modelDimension,colors);
+  int successCount = 0;
+  for (size_t i = 0; i < colors.size(); ++i) {
+    std::vector<Entity*> deferred;
+    CollapseBatch batch;
+    {
+      BatchGatherer gatherer(a,batch);
+      gatherer.gather(colors[i],modelDimension,deferred);
+    }
+    if ( ! deferred.empty()) {
+      if (i + 1 == colors.size())
+        colors.push_back(deferred);
+      else
+        colors[i + 1].insert(colors[i + 1].end(),
+            deferred.begin(), deferred.end());
+    }
+    CollapseEvaluator evaluator(a,batch);
+    apf::parallelFor(batch.vertices.size(),evaluator);
+    int collapsed = applyBatch(a,batch);
+    countOperations(a, batch.vertices.size(), collapsed);
+    successCount += collapsed;
+  }
+  return successCount;
+}
+
 class MatchedEdgeCollapser : public Operator
 {
   public:
@@ -230,6 +608,7 @@ bool coarsen(Adapt* a)
 {
   if (!a->input->shouldCoarsen)
     return false;
+  Stage stage(a, "coarsen");
   double t0 = PCU_Time();
   --(a->coarsensLeft);
   long count = markEdgesToCollapse(a);
@@ -245,8 +624,11 @@ bool coarsen(Adapt* a)
     findIndependentSet(a);
     if (m->hasMatching())
       successCount += collapseMatchedEdges(a, modelDimension);
-    else
+    else {
+      if (a->input->shouldCollapseWithThreads)
+        successCount += collapseEdgesWithThreads(a, modelDimension);
       successCount += collapseAllEdges(a, modelDimension);
+    }
   }
   successCount = PCU_Add_Long(successCount);
   double t1 = PCU_Time();
@@ -21,6 +21,11 @@ void checkAllEdgeCollapses(Adapt* a, int modelDimension);
 void findIndependentSet(Adapt* a);
 
 int collapseAllEdges(Adapt* a, int modelDimension);
+/* interior collapses of linear tets with their quality
+   evaluated on apf::getThreadCount() threads.
+   returns zero if the mesh is not supported, and leaves
+   the remaining collapses to collapseAllEdges */
+int collapseEdgesWithThreads(Adapt* a, int modelDimension);
 
 }
 
@@ -29,6 +29,8 @@ void setDefaultValues(Input* in)
   in->ownsSizeField = true;
   in->maximumIterations = 3;
   in->shouldCoarsen = true;
+  in->shouldCollapseWithThreads = false;
+  in->shouldMeasureEdgesInClosedForm = false;
   in->shouldSnap = in->mesh->canSnap();
   in->shouldTransferParametric = in->mesh->canSnap();
   in->shouldTransferToClosestPoint = false;
@@ -68,6 +70,7 @@ void setDefaultValues(Input* in)
   in->shouldCoarsenLayer = false;
   in->splitAllLayerEdges = false;
   in->userDefinedLayerTagName = "";
+  in->profileFile = "";
   in->shapeHandler = 0;
 }
 
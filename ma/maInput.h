@@ -45,6 +45,17 @@ class Input
     int maximumIterations;
 /** \brief whether to perform the collapse step */
     bool shouldCoarsen;
+/** \brief whether to evaluate edge collapses with threads (default false)
+  \details interior collapses of linear tetrahedral meshes are grouped
+  into sets of non-adjacent vertices whose collapse qualities are
+  computed on apf::getThreadCount() threads before the mesh is changed
+  serially. other collapses are done as usual. */
+    bool shouldCollapseWithThreads;
+/** \brief whether to measure edges in closed form (default false)
+  \details see ma::SizeField::setClosedFormEdges. this speeds up
+  anisotropic adaptation, but since the edge lengths differ slightly
+  from the integrated ones the resulting mesh changes as well. */
+    bool shouldMeasureEdgesInClosedForm;
 /** \brief whether to snap new vertices to the model surface
     \details requires modeler support, see gmi_can_eval */
     bool shouldSnap;
@@ -109,6 +120,11 @@ class Input
     const char* userDefinedLayerTagName;
 /** \brief this a folder that debugging meshes will be written to, if provided! */
     const char* debugFolder;
+/** \brief if not empty, a file that ma::adapt writes the wall time,
+    operation counts, cavity migrations and peak entity counts of
+    each stage to, reduced across parts to min/max/avg.
+    A name ending in .csv gives CSV, others give JSON (default "") */
+    const char* profileFile;
 };
 
 /** \brief generate a configuration based on an anisotropic function.
@@ -1,6 +1,7 @@
 #include <PCU.h>
 #include "maMesh.h"
 #include "maAdapt.h"
+#include "maProfile.h"
 #include "maLayer.h"
 #include "maCoarsen.h"
 #include "maCrawler.h"
@@ -263,6 +264,7 @@ bool coarsenLayer(Adapt* a)
     return false;
   if ( ! a->input->shouldCoarsenLayer)
     return false;
+  Stage stage(a, "coarsenLayer");
   double t0 = PCU_Time();
   allowLayerToCollapse(a);
   findLayerBase(a);
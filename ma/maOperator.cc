@@ -9,6 +9,7 @@
 *******************************************************************************/
 #include "maOperator.h"
 #include "maAdapt.h"
+#include "maProfile.h"
 
 namespace ma {
 
@@ -20,6 +21,8 @@ class CollectiveOperation : public apf::CavityOp, public DeleteCallback
       DeleteCallback(a)
     {
       op = o;
+      target = 0;
+      destroyed = false;
     }
     Outcome setEntity(Entity* e)
     {
@@ -27,18 +30,25 @@ class CollectiveOperation : public apf::CavityOp, public DeleteCallback
         return SKIP;
       if ( ! op->requestLocality(this))
         return REQUEST;
+      target = e;
       return OK;
     }
     void apply()
     {
+      destroyed = false;
       op->apply();
+      countOperations(adapt, 1, destroyed);
     }
     void call(Entity* e)
     {
+      if (e == target)
+        destroyed = true;
       this->preDeletion(e);
     }
   private:
     Operator* op;
+    Entity* target;
+    bool destroyed;
 };
 
 Operator::~Operator() {}
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "maProfile.h"
+#include "maAdapt.h"
+#include <apfCavityOp.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ma {
+
+/* the values kept per stage, in the order they are reduced */
+enum {
+  TIME,
+  ATTEMPTS,
+  SUCCESSES,
+  PULL_ROUNDS,
+  PULLED_ELEMENTS,
+  PEAK_VERTICES,
+  PEAK_EDGES,
+  PEAK_FACES,
+  PEAK_REGIONS,
+  VALUES
+};
+
+static const char* const valueNames[VALUES] = {
+  "time",
+  "attempts",
+  "successes",
+  "pull_rounds",
+  "pulled_elements",
+  "peak_vertices",
+  "peak_edges",
+  "peak_faces",
+  "peak_regions"
+};
+
+struct StageRecord
+{
+  std::string name;
+  int iteration;
+  int depth;
+  double values[VALUES];
+};
+
+class Profile
+{
+  public:
+    Profile(Mesh* m)
+    {
+      mesh = m;
+      iteration = -1;
+    }
+    void begin(const char* name)
+    {
+      StageRecord r;
+      r.name = name;
+      r.iteration = iteration;
+      r.depth = open.size();
+      for (int i = 0; i < VALUES; ++i)
+        r.values[i] = 0;
+      int rounds;
+      long elements;
+      apf::getCavityPulls(rounds, elements);
+      r.values[TIME] = -PCU_Time();
+      r.values[PULL_ROUNDS] = -rounds;
+      r.values[PULLED_ELEMENTS] = -elements;
+      open.push_back(records.size());
+      records.push_back(r);
+      measurePeaks(records.back());
+    }
+    void end()
+    {
+      PCU_ALWAYS_ASSERT( ! open.empty());
+      StageRecord& r = records[open.back()];
+      open.pop_back();
+      int rounds;
+      long elements;
+      apf::getCavityPulls(rounds, elements);
+      r.values[TIME] += PCU_Time();
+      r.values[PULL_ROUNDS] += rounds;
+      r.values[PULLED_ELEMENTS] += elements;
+      measurePeaks(r);
+      /* the peaks of a stage are also those of its parent */
+      if ( ! open.empty()) {
+        StageRecord& parent = records[open.back()];
+        for (int i = PEAK_VERTICES; i <= PEAK_REGIONS; ++i)
+          if (r.values[i] > parent.values[i])
+            parent.values[i] = r.values[i];
+      }
+    }
+    void count(long attempts, long successes)
+    {
+      if (open.empty())
+        return;
+      StageRecord& r = records[open.back()];
+      r.values[ATTEMPTS] += attempts;
+      r.values[SUCCESSES] += successes;
+    }
+    void write(const char* filename);
+    int iteration;
+  private:
+    /* entity counts are sampled as stages open and close */
+    void measurePeaks(StageRecord& r)
+    {
+      for (int d = 0; d <= 3; ++d) {
+        double n = d <= mesh->getDimension() ? mesh->count(d) : 0;
+        if (n > r.values[PEAK_VERTICES + d])
+          r.values[PEAK_VERTICES + d] = n;
+      }
+    }
+    Mesh* mesh;
+    std::vector<StageRecord> records;
+    std::vector<size_t> open;
+};
+
+static bool endsWith(const char* s, const char* suffix)
+{
+  size_t n = strlen(s);
+  size_t m = strlen(suffix);
+  return n >= m && !strcmp(s + n - m, suffix);
+}
+
+static void writeJson(FILE* f, std::vector<StageRecord>& records,
+    std::vector<double>& mins, std::vector<double>& maxs,
+    std::vector<double>& avgs)
+{
+  fprintf(f, "{\n  \"parts\": %d,\n  \"stages\": [", PCU_Comm_Peers());
+  for (size_t i = 0; i < records.size(); ++i) {
+    StageRecord& r = records[i];
+    fprintf(f, "%s\n    {\"name\": \"%s\", \"iteration\": %d, \"depth\": %d",
+        i ? "," : "", r.name.c_str(), r.iteration, r.depth);
+    for (int j = 0; j < VALUES; ++j) {
+      size_t k = i * VALUES + j;
+      fprintf(f, ",\n     \"%s\": {\"min\": %.9g, \"max\": %.9g, \"avg\": %.9g}",
+          valueNames[j], mins[k], maxs[k], avgs[k]);
+    }
+    fprintf(f, "}");
+  }
+  fprintf(f, "\n  ]\n}\n");
+}
+
+static void writeCsv(FILE* f, std::vector<StageRecord>& records,
+    std::vector<double>& mins, std::vector<double>& maxs,
+    std::vector<double>& avgs)
+{
+  fprintf(f, "stage,iteration,depth");
+  for (int j = 0; j < VALUES; ++j)
+    fprintf(f, ",%s_min,%s_max,%s_avg",
+        valueNames[j], valueNames[j], valueNames[j]);
+  fprintf(f, "\n");
+  for (size_t i = 0; i < records.size(); ++i) {
+    StageRecord& r = records[i];
+    fprintf(f, "%s,%d,%d", r.name.c_str(), r.iteration, r.depth);
+    for (int j = 0; j < VALUES; ++j) {
+      size_t k = i * VALUES + j;
+      fprintf(f, ",%.9g,%.9g,%.9g", mins[k], maxs[k], avgs[k]);
+    }
+    fprintf(f, "\n");
+  }
+}
+
+void Profile::write(const char* filename)
+{
+  PCU_ALWAYS_ASSERT(open.empty());
+  int n = records.size();
+  PCU_ALWAYS_ASSERT(PCU_Min_Int(n) == PCU_Max_Int(n));
+  std::vector<double> mins(n * VALUES);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < VALUES; ++j)
+      mins[i * VALUES + j] = records[i].values[j];
+  std::vector<double> maxs(mins);
+  std::vector<double> avgs(mins);
+  if (n) {
+    PCU_Min_Doubles(&mins[0], mins.size());
+    PCU_Max_Doubles(&maxs[0], maxs.size());
+    PCU_Add_Doubles(&avgs[0], avgs.size());
+  }
+  for (size_t i = 0; i < avgs.size(); ++i)
+    avgs[i] /= PCU_Comm_Peers();
+  if (PCU_Comm_Self())
+    return;
+  FILE* f = fopen(filename, "w");
+  if ( ! f) {
+    lion_eprint(1, "MeshAdapt could not open profile file \"%s\"\n", filename);
+    abort();
+  }
+  if (endsWith(filename, ".csv"))
+    writeCsv(f, records, mins, maxs, avgs);
+  else
+    writeJson(f, records, mins, maxs, avgs);
+  fclose(f);
+}
+
+Profile* createProfile(Adapt* a)
+{
+  return new Profile(a->mesh);
+}
+
+void destroyProfile(Profile* p)
+{
+  delete p;
+}
+
+Stage::Stage(Adapt* a, const char* name):
+  adapt(a)
+{
+  adapt->profile->begin(name);
+}
+
+Stage::~Stage()
+{
+  adapt->profile->end();
+}
+
+void setIteration(Adapt* a, int iteration)
+{
+  a->profile->iteration = iteration;
+}
+
+void countOperations(Adapt* a, long attempts, long successes)
+{
+  a->profile->count(attempts, successes);
+}
+
+void writeProfile(Adapt* a, const char* filename)
+{
+  a->profile->write(filename);
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef MA_PROFILE_H
+#define MA_PROFILE_H
+
+namespace ma {
+
+class Adapt;
+class Profile;
+
+Profile* createProfile(Adapt* a);
+void destroyProfile(Profile* p);
+
+/* one stage of adaptation, from construction to destruction.
+   stages nest, and the time of a stage includes the stages it
+   runs. every part must run the same stages in the same order,
+   so they should only be opened by collective functions. */
+class Stage
+{
+  public:
+    Stage(Adapt* a, const char* name);
+    ~Stage();
+  private:
+    Adapt* adapt;
+};
+
+/* the adapt iteration that new stages belong to,
+   -1 for those outside the refinement loop */
+void setIteration(Adapt* a, int iteration);
+
+/* counts local operations towards the innermost stage.
+   applyOperator counts one attempt per apply() call and a
+   success when that call destroys the entity it was given. */
+void countOperations(Adapt* a, long attempts, long successes);
+
+/* reduces the stages across parts and has part 0 write them to
+   a file, as CSV if the name ends with .csv and JSON otherwise */
+void writeProfile(Adapt* a, const char* filename);
+
+}
+
+#endif
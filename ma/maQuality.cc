@@ -184,10 +184,9 @@ double measureElementQuality(Mesh* m, SizeField* f, Entity* e, bool useMax)
 double getWorstQuality(Adapt* a, Entity** e, size_t n)
 {
   PCU_ALWAYS_ASSERT(n);
-  Mesh* m = a->mesh;
   ShapeHandler* sh = a->shape;
   double worst;
-  if (m->hasTag(e[0], a->qualityCache))
+  if (hasCachedQuality(a, e[0]))
     worst = getCachedQuality(a, e[0]);
   else {
     worst = sh->getQuality(e[0]);
@@ -195,7 +194,7 @@ double getWorstQuality(Adapt* a, Entity** e, size_t n)
   }
   for (size_t i = 1; i < n; ++i) {
     double quality;
-    if (m->hasTag(e[i], a->qualityCache)) {
+    if (hasCachedQuality(a, e[i])) {
       quality = getCachedQuality(a, e[i]);
     }
     else {
@@ -300,6 +299,60 @@ double measureLinearTetQuality(Vector xyz[4])
   return 15552*(V*V)/(s*s*s);
 }
 
+/* same choice of metric as getMetricWithMaxJacobean */
+static int getMaxJacobianTransform(Matrix const Q[], int n, int dim)
+{
+  int best = 0;
+  double maxJ = -1.0;
+  for (int i = 0; i < n; ++i) {
+    double j = apf::getJacobianDeterminant(Q[i], dim);
+    if (j > maxJ) {
+      maxJ = j;
+      best = i;
+    }
+  }
+  return best;
+}
+
+double measureLinearTetQuality(Vector const xyz[4], Matrix const Q[4])
+{
+  int best = getMaxJacobianTransform(Q, 4, 3);
+  /* rows of J times Q are the edges in metric space,
+     which for straight edges are also their metric lengths */
+  Matrix QT = apf::transpose(Q[best]);
+  Matrix J;
+  J[0] = xyz[1] - xyz[0];
+  J[1] = xyz[2] - xyz[0];
+  J[2] = xyz[3] - xyz[0];
+  double V = apf::getDeterminant(J * Q[best]) / 6;
+  double s = 0;
+  for (int i = 0; i < 6; ++i) {
+    int const* ev = apf::tet_edge_verts[i];
+    double l = (QT * (xyz[ev[1]] - xyz[ev[0]])).getLength();
+    s += l * l;
+  }
+  if (V < 0)
+    return -15552*(V*V)/(s*s*s);
+  return 15552*(V*V)/(s*s*s);
+}
+
+double measureLinearTriQuality(Vector const xyz[3], Matrix const Q[3],
+    int dim)
+{
+  int best = getMaxJacobianTransform(Q, 3, dim);
+  Matrix QT = apf::transpose(Q[best]);
+  Vector a = QT * (xyz[1] - xyz[0]);
+  Vector b = QT * (xyz[2] - xyz[0]);
+  double A = apf::cross(a, b).getLength() / 2;
+  double s = 0;
+  for (int i = 0; i < 3; ++i) {
+    int const* ev = apf::tri_edge_verts[i];
+    double l = (QT * (xyz[ev[1]] - xyz[ev[0]])).getLength();
+    s += l * l;
+  }
+  return 48*(A*A)/(s*s);
+}
+
 /* helper for measureBezierTetQuality only.
    hardcoded the only inputs for speed.*/
 static int factorial(int num)
@@ -11,6 +11,7 @@
 #include "maRefine.h"
 #include "maTemplates.h"
 #include "maAdapt.h"
+#include "maProfile.h"
 #include "maMesh.h"
 #include "maTables.h"
 #include "maMatch.h"
@@ -234,6 +235,46 @@ static SplitFunction* all_templates[apf::Mesh::TYPES] =
  pyramid_templates //pyramid
 };
 
+/* counts what the templates will create and reserves room for it
+   in the mesh, before any of it is built. A face with k split edges
+   becomes k+1 triangles with k new edges between them, and by Euler's
+   formula a tet that becomes T tets through k split edges has
+   2T-k-2 new faces and T-k-1 new edges inside it.
+   Templates for other element types are left to grow the mesh. */
+void reserveRefine(Refine* r)
+{
+  Adapt* a = r->adapt;
+  Mesh* m = a->mesh;
+  long n[apf::Mesh::TYPES] = {0};
+  n[apf::Mesh::VERTEX] = r->toSplit[1].getSize();
+  n[apf::Mesh::EDGE] = 2 * r->toSplit[1].getSize();
+  for (int d=2; d <= m->getDimension(); ++d)
+    for (size_t i=0; i < r->toSplit[d].getSize(); ++i)
+    {
+      Entity* e = r->toSplit[d][i];
+      int type = m->getType(e);
+      int code = getEdgeSplitCode(a,e);
+      int k = 0;
+      for (int c = code; c; c >>= 1)
+        k += c & 1;
+      if (type == apf::Mesh::TRIANGLE)
+      {
+        n[apf::Mesh::TRIANGLE] += k + 1;
+        n[apf::Mesh::EDGE] += k;
+      }
+      else if (type == apf::Mesh::TET)
+      {
+        int t = tet_template_tets[code_match[type][code].code_index];
+        n[apf::Mesh::TET] += t;
+        n[apf::Mesh::TRIANGLE] += 2 * t - k - 2;
+        n[apf::Mesh::EDGE] += t - k - 1;
+      }
+    }
+  for (int t=0; t < apf::Mesh::TYPES; ++t)
+    if (n[t])
+      m->reserve(t,n[t]);
+}
+
 void splitElement(Refine* r, Entity* e)
 {
   Adapt* a = r->adapt;
@@ -408,6 +449,7 @@ void cleanupAfter(Refine* r)
 
 bool refine(Adapt* a)
 {
+  Stage stage(a, "refine");
   double t0 = PCU_Time();
   --(a->refinesLeft);
   setupLayerForSplit(a);
@@ -423,6 +465,8 @@ bool refine(Adapt* a)
   collectForMatching(r);
   setupRefineForLayer(r);
   addAllMarkedEdges(r);
+  countOperations(a, r->toSplit[1].getSize(), r->toSplit[1].getSize());
+  reserveRefine(r);
   splitElements(r);
   processNewElements(r);
   destroySplitElements(r);
@@ -59,6 +59,7 @@ void transferElements(Refine* r);
 void forgetNewEntities(Refine* r);
 void destroySplitElements(Refine* r);
 
+void reserveRefine(Refine* r);
 void splitElements(Refine* r);
 void processNewElements(Refine* r);
 void cleanupAfter(Refine* r);
@@ -22,7 +22,11 @@
 #include "maShapeHandler.h"
 #include "maBalance.h"
 #include "maDBG.h"
+#include "maProfile.h"
 #include <pcu_util.h>
+#include <queue>
+#include <map>
+#include <set>
 
 namespace ma {
 
@@ -171,6 +175,214 @@ double getMinQuality(Adapt* a)
   return PCU_Min_Double(minqual);
 }
 
+/* the elements of bad quality, kept from one operator to the
+   next so that the shape correction loop does not need to sweep
+   the whole part after each one to find them again.
+   elements come out worst first, and only the elements built
+   by an operator are measured after it is applied. */
+class BadElements
+{
+  public:
+    BadElements(Adapt* a):
+      adapter(a)
+    {
+    }
+    /* find the bad elements with a full sweep, which
+       expects no element to be flagged BAD_QUALITY */
+    void mark()
+    {
+      members.clear();
+      Collect p(this);
+      markEntities(adapter, adapter->mesh->getDimension(), p,
+          BAD_QUALITY, OK_QUALITY);
+      refill();
+    }
+    /* forget all bad elements and clear their flags */
+    void clear()
+    {
+      APF_ITERATE(Members, members, it)
+        if (getFlag(adapter, it->first, BAD_QUALITY))
+          clearFlag(adapter, it->first, BAD_QUALITY);
+      members.clear();
+      heap = Heap();
+    }
+    /* the same as mark, for when the mesh was changed
+       without this structure seeing it, in which case
+       the members may no longer exist */
+    void reset()
+    {
+      members.clear();
+      heap = Heap();
+      unMarkBadQuality(adapter);
+      mark();
+    }
+    long count()
+    {
+      return PCU_Add_Long(members.size());
+    }
+    /* flag the remaining bad elements, including those
+       that operators failed to fix, for the next pass */
+    void refill()
+    {
+      heap = Heap();
+      APF_ITERATE(Members, members, it) {
+        setFlag(adapter, it->first, BAD_QUALITY);
+        heap.push(Item(it->second, it->first));
+      }
+    }
+    /* the next element of this pass, or zero */
+    Entity* pop()
+    {
+      while ( ! heap.empty()) {
+        Item i = heap.top();
+        heap.pop();
+        Members::iterator it = members.find(i.second);
+        /* entities destroyed since, or whose storage was
+           reused by a new element, are not what we queued */
+        if (it != members.end() && it->second == i.first)
+          return i.second;
+      }
+      return 0;
+    }
+    void forget(Entity* e)
+    {
+      members.erase(e);
+    }
+    /* measure the elements around a vertex that no pass
+       has seen yet, which are those built by an operator */
+    void visit(Entity* v)
+    {
+      Mesh* m = adapter->mesh;
+      apf::Adjacent elements;
+      m->getAdjacent(v, m->getDimension(), elements);
+      for (size_t i = 0; i < elements.getSize(); ++i) {
+        Entity* e = elements[i];
+        if (getFlags(adapter, e) & (BAD_QUALITY | OK_QUALITY))
+          continue;
+        if (members.count(e))
+          continue;
+        double q = adapter->shape->getQuality(e);
+        if (q < adapter->input->goodQuality)
+          members[e] = q;
+        else
+          setFlag(adapter, e, OK_QUALITY);
+      }
+    }
+  private:
+    typedef std::map<Entity*, double> Members;
+    typedef std::pair<double, Entity*> Item;
+    struct WorseFirst
+    {
+      bool operator()(Item const& a, Item const& b) const
+      {
+        return a.first > b.first;
+      }
+    };
+    typedef std::priority_queue<Item, std::vector<Item>, WorseFirst> Heap;
+    struct Collect : public Predicate
+    {
+      Collect(BadElements* b_):b(b_) {}
+      bool operator()(Entity* e)
+      {
+        double q = b->adapter->shape->getQuality(e);
+        if (q >= b->adapter->input->goodQuality)
+          return false;
+        b->members[e] = q;
+        return true;
+      }
+      BadElements* b;
+    };
+    Adapt* adapter;
+    Members members;
+    Heap heap;
+};
+
+/* applies an operator to the queued bad elements only.
+   cavities that are not local are left for applyOperator,
+   since migration invalidates the queued entities. */
+class BadElementOperation : public apf::CavityOp, public DeleteCallback
+{
+  public:
+    BadElementOperation(Adapt* a, Operator* o, BadElements* b):
+      apf::CavityOp(a->mesh, true),
+      DeleteCallback(a)
+    {
+      op = o;
+      bad = b;
+      dimension = a->mesh->getDimension();
+      target = 0;
+      destroyed = false;
+    }
+    Outcome setEntity(Entity* e)
+    {
+      if ( ! op->shouldApply(e))
+        return SKIP;
+      if ( ! op->requestLocality(this))
+        return REQUEST;
+      target = e;
+      return OK;
+    }
+    void apply()
+    {
+      destroyed = false;
+      op->apply();
+      countOperations(adapt, 1, destroyed);
+    }
+    /* the vertices of destroyed elements bound the cavities
+       where new elements were built. vertices destroyed
+       later in the pass are dropped again */
+    void call(Entity* e)
+    {
+      int d = getDimension(mesh, e);
+      if (d == 0)
+        touched.erase(e);
+      if (d != dimension)
+        return;
+      if (e == target)
+        destroyed = true;
+      bad->forget(e);
+      Downward v;
+      int nv = mesh->getDownward(e, 0, v);
+      touched.insert(v, v + nv);
+    }
+    void run()
+    {
+      sharing = apf::getSharing(mesh);
+      Entity* e;
+      while ((e = bad->pop()))
+        if (sharing->isOwned(e) && setEntity(e) == OK)
+          apply();
+      /* new elements wait for the next pass anyway, so they
+         are measured once here rather than after each apply */
+      APF_ITERATE(std::set<Entity*>, touched, it)
+        bad->visit(*it);
+      touched.clear();
+      delete sharing;
+      sharing = 0;
+    }
+  private:
+    Operator* op;
+    BadElements* bad;
+    int dimension;
+    Entity* target;
+    bool destroyed;
+    std::set<Entity*> touched;
+};
+
+static void applyToBadElements(Adapt* a, Operator* o, BadElements* bad)
+{
+  {
+    BadElementOperation op(a, o, bad);
+    op.run();
+  }
+  if (PCU_Comm_Peers() == 1) {
+    bad->refill();
+    return;
+  }
+  applyOperator(a, o);
+  bad->reset();
+}
+
 class ShortEdgeFixer : public Operator
 {
   public:
@@ -739,37 +951,38 @@ class QualityImprover2D : public Operator
     int nf;
 };
 
-static double fixShortEdgeElements(Adapt* a)
+static double fixShortEdgeElements(Adapt* a, BadElements* bad)
 {
+  Stage stage(a, "fixShortEdgeElements");
   double t0 = PCU_Time();
   ShortEdgeFixer fixer(a);
-  applyOperator(a,&fixer);
+  applyToBadElements(a,&fixer,bad);
   double t1 = PCU_Time();
   return t1 - t0;
 }
 
-static void fixLargeAngleTets(Adapt* a)
+static void fixLargeAngleTets(Adapt* a, BadElements* bad)
 {
   LargeAngleTetFixer fixer(a);
-  applyOperator(a,&fixer);
+  applyToBadElements(a,&fixer,bad);
 }
 
-static void fixLargeAngleTris(Adapt* a)
+static void fixLargeAngleTris(Adapt* a, BadElements* bad)
 {
   LargeAngleTriFixer fixer(a);
-  applyOperator(a,&fixer);
+  applyToBadElements(a,&fixer,bad);
 }
 
-static void alignLargeAngleTets(Adapt* a)
+static void alignLargeAngleTets(Adapt* a, BadElements* bad)
 {
   LargeAngleTetAligner aligner(a);
-  applyOperator(a,&aligner);
+  applyToBadElements(a,&aligner,bad);
 }
 
-static void alignLargeAngleTris(Adapt* a)
+static void alignLargeAngleTris(Adapt* a, BadElements* bad)
 {
   LargeAngleTriFixer aligner(a);
-  applyOperator(a,&aligner);
+  applyToBadElements(a,&aligner,bad);
 }
 
 static void improveQualities2D(Adapt* a)
@@ -778,27 +991,30 @@ static void improveQualities2D(Adapt* a)
   applyOperator(a, &improver);
 }
 
-static double fixLargeAngles(Adapt* a)
+static double fixLargeAngles(Adapt* a, BadElements* bad)
 {
+  Stage stage(a, "fixLargeAngles");
   double t0 = PCU_Time();
   if (a->mesh->getDimension()==3)
-    fixLargeAngleTets(a);
+    fixLargeAngleTets(a,bad);
   else
-    fixLargeAngleTris(a);
+    fixLargeAngleTris(a,bad);
   double t1 = PCU_Time();
   return t1 - t0;
 }
 
-static void alignLargeAngles(Adapt* a)
+static void alignLargeAngles(Adapt* a, BadElements* bad)
 {
+  Stage stage(a, "alignLargeAngles");
   if (a->mesh->getDimension()==3)
-    alignLargeAngleTets(a);
+    alignLargeAngleTets(a,bad);
   else
-    alignLargeAngleTris(a);
+    alignLargeAngleTris(a,bad);
 }
 
 double improveQualities(Adapt* a)
 {
+  Stage stage(a, "improveQualities");
   double t0 = PCU_Time();
   if (a->mesh->getDimension() == 3)
     return 0; // TODO: implement this for 3D
@@ -812,8 +1028,11 @@ void fixElementShapes(Adapt* a)
 {
   if ( ! a->input->shouldFixShape)
     return;
+  Stage stage(a, "fixElementShapes");
   double t0 = PCU_Time();
-  int count = markBadQuality(a);
+  BadElements bad(a);
+  bad.mark();
+  int count = bad.count();
   int originalCount = count;
   int prev_count;
   double time;
@@ -823,27 +1042,33 @@ void fixElementShapes(Adapt* a)
       break;
     prev_count = count;
     print("--iter %d of shape correction loop: #bad elements %d", iter, count);
-    time = fixLargeAngles(a);
+    time = fixLargeAngles(a, &bad);
     /* We need to snap the new verts as soon as they are
      * created (to avoid future problems). At the moment
      * new verts are created only during 3D mesh adapt, so
      * we only run a bulk snap operation if the mesh is 3D.
      */
-    if (a->mesh->getDimension() == 3)
+    if (a->mesh->getDimension() == 3 && a->input->shouldSnap) {
       snap(a);
-    count = markBadQuality(a);
+      bad.reset();
+    }
+    count = bad.count();
     print("--fixLargeAngles       in %f seconds: #bad elements %d",time,count);
-    time = fixShortEdgeElements(a);
-    count = markBadQuality(a);
+    time = fixShortEdgeElements(a, &bad);
+    count = bad.count();
     print("--fixShortEdgeElements in %f seconds: #bad elements %d",time,count);
     if (count >= prev_count)
-      unMarkBadQuality(a); // to make sure markEntities does not complain!
+      bad.clear(); // to make sure markEntities does not complain!
     // balance the mesh to avoid empty parts
-    midBalance(a);
+    if (PCU_Comm_Peers() > 1) {
+      midBalance(a);
+      bad.reset();
+    }
     print("--percent change in number of bad elements %f",
 	((double) prev_count - (double) count) / (double) prev_count);
     iter++;
   } while(count < prev_count);
+  bad.clear();
   double t1 = PCU_Time();
   print("bad shapes down from %d to %d in %f seconds",
         originalCount,count,t1-t0);
@@ -854,8 +1079,11 @@ void alignElements(Adapt* a)
   int max_iter = 5;
   if ( ! a->input->shouldFixShape)
     return;
+  Stage stage(a, "alignElements");
   double t0 = PCU_Time();
-  int count = markBadQuality(a);
+  BadElements bad(a);
+  bad.mark();
+  int count = bad.count();
   int originalCount = count;
   int prev_count;
   int i = 0;
@@ -863,12 +1091,11 @@ void alignElements(Adapt* a)
     if ( ! count)
       break;
     prev_count = count;
-    alignLargeAngles(a);
-    count = markBadQuality(a);
+    alignLargeAngles(a, &bad);
+    count = bad.count();
     ++i;
-    if (count >= prev_count || i >= max_iter)
-      unMarkBadQuality(a);
   } while(count < prev_count && i < max_iter);
+  bad.clear();
 
   double t1 = PCU_Time();
   print("non-aligned elements down from %d to %d in %f seconds",
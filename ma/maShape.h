@@ -29,6 +29,16 @@ double measureElementQuality(Mesh* m, SizeField* f, Entity* e, bool useMax=true)
  * the vertices used for curved elements
  */
 double measureLinearTetQuality(Vector xyz[4]);
+/* what measureTetQuality gives for a linear tet with these vertices,
+ * given the size field transform Q at each vertex,
+ * without needing the tet to exist in the mesh
+ */
+double measureLinearTetQuality(Vector const xyz[4], Matrix const Q[4]);
+/* the same for measureTriQuality, where (dim) is the mesh
+ * dimension used to compare the transforms
+ */
+double measureLinearTriQuality(Vector const xyz[3], Matrix const Q[3],
+    int dim);
 double measureQuadraticTetQuality(Mesh* m, Entity* tet);
 
 double getWorstQuality(Adapt* a, EntityArray& e);
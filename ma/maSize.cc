@@ -11,7 +11,11 @@
 #include "maSize.h"
 #include "apfMatrix.h"
 #include <apfShape.h>
+#include <apfThreads.h>
+#include <apfMDS.h>
 #include <cstdlib>
+#include <algorithm>
+#include <vector>
 #include <pcu_util.h>
 
 namespace ma {
@@ -20,6 +24,16 @@ SizeField::~SizeField()
 {
 }
 
+void SizeField::measureEdges(Entity** edges, int n, double* lengths)
+{
+  for (int i = 0; i < n; ++i)
+    lengths[i] = measure(edges[i]);
+}
+
+void SizeField::setClosedFormEdges(bool)
+{
+}
+
 IdentitySizeField::IdentitySizeField(Mesh* m):
   mesh(m)
 {
@@ -177,16 +191,159 @@ class SizeFieldIntegrator : public apf::Integrator
     int dimension;
 };
 
+/* the metric tensor M = Q Q^T stored as its diagonal
+   followed by the upper off-diagonal terms, so that
+   the metric length of a vector d is sqrt(d^T M d) */
+static void getMetric(Matrix const& Q, double* m)
+{
+  Matrix M = Q * transpose(Q);
+  m[0] = M[0][0];
+  m[1] = M[1][1];
+  m[2] = M[2][2];
+  m[3] = M[0][1];
+  m[4] = M[0][2];
+  m[5] = M[1][2];
+}
+
+/* the length of a straight edge whose metric lengths measured
+   with the metrics of its two vertices are l0 and l1.
+   the length is interpolated geometrically along the edge,
+   which is what log-Euclidean interpolation of the vertex
+   metrics gives when they share principal directions,
+   and its integral is then (l1 - l0) / ln(l1 / l0) */
+static double interpolateLength(double l0, double l1)
+{
+  if (l0 <= 0 || l1 <= 0)
+    return (l0 + l1) / 2;
+  double r = l1 / l0;
+  /* the error of the arithmetic mean is about l0 (r - 1)^2 / 12 */
+  if (fabs(r - 1) < 1e-4)
+    return (l0 + l1) / 2;
+  return (l1 - l0) / log(r);
+}
+
+/* the number of edges measureEdges works on at a time */
+enum { EDGE_BATCH = 64 };
+
+/* metric size fields can measure straight edges in closed form
+   from the metrics at their vertices, see setClosedFormEdges.
+   the vertex metrics are then cached in an array owned by the
+   size field and indexed by MDS vertex slot, each one next to
+   the size values it was computed from, so that it is recomputed
+   once those change or the slot holds another vertex.
+   measure and measureEdges fill this cache, so unlike the other
+   size fields they must not be called from several threads at once. */
 struct MetricSizeField : public SizeField
 {
+  MetricSizeField():
+    mesh(0),
+    closedForm(false)
+  {
+  }
+  void setClosedFormEdges(bool on)
+  {
+    closedForm = on && apf::isMdsMesh(mesh) &&
+      mesh->getShape()->getOrder() == 1;
+    vertexCache.clear();
+  }
+  enum { MAX_VALUES = 12 };
+  /* copies the size values at a vertex into (values)
+     and returns how many there are, at most MAX_VALUES */
+  virtual int getVertexValues(Entity* v, double* values) = 0;
+  /* the transform given by the size values at a vertex,
+     which getTransform gives at that vertex */
+  virtual void makeVertexTransform(double const* values, Matrix& Q) = 0;
+  struct CachedMetric
+  {
+    bool valid;
+    double values[MAX_VALUES];
+    double metric[6];
+  };
+  void getVertexMetric(Entity* v, double* metric)
+  {
+    double values[MAX_VALUES];
+    int n = getVertexValues(v, values);
+    size_t i = apf::getMdsTypeIndex(v);
+    if (i >= vertexCache.size())
+      vertexCache.resize(std::max(i + 1, vertexCache.size() * 2));
+    CachedMetric& c = vertexCache[i];
+    if (!(c.valid && std::equal(values, values + n, c.values))) {
+      Matrix Q;
+      makeVertexTransform(values, Q);
+      std::copy(values, values + n, c.values);
+      getMetric(Q, c.metric);
+      c.valid = true;
+    }
+    std::copy(c.metric, c.metric + 6, metric);
+  }
+  /* the vector along a straight edge and the metrics at its ends */
+  void getEdgeMetrics(Entity* e, double* d, double* m0, double* m1)
+  {
+    Entity* v[2];
+    mesh->getDownward(e, 0, v);
+    Vector x = getPosition(mesh, v[1]) - getPosition(mesh, v[0]);
+    x.toArray(d);
+    getVertexMetric(v[0], m0);
+    getVertexMetric(v[1], m1);
+  }
+  static double getMetricLength(double const* m, double const* d)
+  {
+    return sqrt(m[0]*d[0]*d[0] + m[1]*d[1]*d[1] + m[2]*d[2]*d[2]
+        + 2*(m[3]*d[0]*d[1] + m[4]*d[0]*d[2] + m[5]*d[1]*d[2]));
+  }
+  double measureEdge(Entity* e)
+  {
+    double d[3];
+    double m0[6];
+    double m1[6];
+    getEdgeMetrics(e, d, m0, m1);
+    return interpolateLength(getMetricLength(m0, d), getMetricLength(m1, d));
+  }
   double measure(Entity* e)
   {
+    if (closedForm && mesh->getType(e) == apf::Mesh::EDGE)
+      return measureEdge(e);
     SizeFieldIntegrator sFI(this); 
     apf::MeshElement* me = apf::createMeshElement(mesh, e);
     sFI.process(me);
     apf::destroyMeshElement(me);
     return sFI.measurement;
   }
+  /* gathers the edge vectors and vertex metric components
+     into arrays, then computes the lengths in loops over those */
+  void measureEdges(Entity** edges, int n, double* lengths)
+  {
+    if (!closedForm) {
+      SizeField::measureEdges(edges, n, lengths);
+      return;
+    }
+    double d[3][EDGE_BATCH];
+    double m[2][6][EDGE_BATCH];
+    double l[2][EDGE_BATCH];
+    for (int start = 0; start < n; start += EDGE_BATCH) {
+      int k = std::min(n - start, (int)EDGE_BATCH);
+      for (int b = 0; b < k; ++b) {
+        double ed[3];
+        double em[2][6];
+        getEdgeMetrics(edges[start + b], ed, em[0], em[1]);
+        for (int a = 0; a < 3; ++a)
+          d[a][b] = ed[a];
+        for (int j = 0; j < 2; ++j)
+          for (int a = 0; a < 6; ++a)
+            m[j][a][b] = em[j][a];
+      }
+      for (int j = 0; j < 2; ++j)
+        for (int b = 0; b < k; ++b)
+          l[j][b] = sqrt(m[j][0][b]*d[0][b]*d[0][b]
+                       + m[j][1][b]*d[1][b]*d[1][b]
+                       + m[j][2][b]*d[2][b]*d[2][b]
+                       + 2*(m[j][3][b]*d[0][b]*d[1][b]
+                          + m[j][4][b]*d[0][b]*d[2][b]
+                          + m[j][5][b]*d[1][b]*d[2][b]));
+      for (int b = 0; b < k; ++b)
+        lengths[start + b] = interpolateLength(l[0][b], l[1][b]);
+    }
+  }
   bool shouldSplit(Entity* edge)
   {
     return this->measure(edge) > 1.5;
@@ -201,6 +358,8 @@ struct MetricSizeField : public SizeField
     return measure(e) / parentMeasure[mesh->getType(e)];
   }
   Mesh* mesh;
+  bool closedForm;
+  std::vector<CachedMetric> vertexCache;
 };
 
 AnisotropicFunction::~AnisotropicFunction()
@@ -360,6 +519,14 @@ struct AnisoSizeField : public MetricSizeField
     hField = sizes;
     rField = frames;
   }
+  static void makeTransform(Matrix R, Vector const& h, Matrix& Q)
+  {
+    orthogonalizeR(R);
+    Matrix S(1/h[0],0,0,
+             0,1/h[1],0,
+             0,0,1/h[2]);
+    Q = R*S;
+  }
   void getTransform(
       apf::MeshElement* me,
       Vector const& xi,
@@ -373,11 +540,26 @@ struct AnisoSizeField : public MetricSizeField
     apf::getMatrix(rElement,xi,R);
     apf::destroyElement(hElement);
     apf::destroyElement(rElement);
-    orthogonalizeR(R);
-    Matrix S(1/h[0],0,0,
-             0,1/h[1],0,
-             0,0,1/h[2]);
-    Q = R*S;
+    makeTransform(R, h, Q);
+  }
+  int getVertexValues(Entity* v, double* values)
+  {
+    Vector h;
+    Matrix R;
+    apf::getVector(hField,v,0,h);
+    apf::getMatrix(rField,v,0,R);
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        values[3 * i + j] = R[i][j];
+    h.toArray(values + 9);
+    return 12;
+  }
+  void makeVertexTransform(double const* values, Matrix& Q)
+  {
+    Matrix R(values[0], values[1], values[2],
+             values[3], values[4], values[5],
+             values[6], values[7], values[8]);
+    makeTransform(R, Vector(values + 9), Q);
   }
   void interpolate(
       apf::MeshElement* parent,
@@ -453,6 +635,7 @@ struct LogAnisoSizeField : public MetricSizeField
               0    , 0   , s[2]);
       apf::setMatrix(logMField, v, 0, f * S * transpose(f));
     }
+    m->end(it);
   }
   void getTransform(
       apf::MeshElement* me,
@@ -463,6 +646,10 @@ struct LogAnisoSizeField : public MetricSizeField
     Matrix logM;
     apf::getMatrix(logMElement,xi,logM);
     apf::destroyElement(logMElement);
+    makeTransform(logM, Q);
+  }
+  static void makeTransform(Matrix const& logM, Matrix& Q)
+  {
     Vector v;
     Matrix R;
     orthogonalEigenDecompForSymmetricMatrix(logM, v, R);
@@ -471,6 +658,22 @@ struct LogAnisoSizeField : public MetricSizeField
               0, 0, sqrt(exp(v[2])));
     Q = R*S;
   }
+  int getVertexValues(Entity* v, double* values)
+  {
+    Matrix logM;
+    apf::getMatrix(logMField,v,0,logM);
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        values[3 * i + j] = logM[i][j];
+    return 9;
+  }
+  void makeVertexTransform(double const* values, Matrix& Q)
+  {
+    Matrix logM(values[0], values[1], values[2],
+                values[3], values[4], values[5],
+                values[6], values[7], values[8]);
+    makeTransform(logM, Q);
+  }
   void interpolate(
       apf::MeshElement* parent,
       Vector const& xi,
@@ -574,44 +777,95 @@ SizeField* makeSizeField(Mesh* m, apf::Field* size)
   return new IsoUserField(m, size);
 }
 
+/* measures edges with the identity size field, which is purely
+   geometric and can therefore be evaluated from several threads */
+class EdgeLengthOp : public apf::ParallelOp
+{
+  public:
+    EdgeLengthOp(Mesh* m, bool owned):
+      mesh(m),
+      sizeField(m),
+      onlyOwned(owned),
+      sums(apf::getThreadCount(), 0),
+      counts(apf::getThreadCount(), 0),
+      maxima(apf::getThreadCount(), 0)
+    {
+    }
+    void apply(Entity* e, int thread)
+    {
+      if (onlyOwned && !mesh->isOwned(e))
+        return;
+      double length = sizeField.measure(e);
+      sums[thread] += length;
+      counts[thread] += 1.0;
+      if (length > maxima[thread])
+        maxima[thread] = length;
+    }
+    void run()
+    {
+      apf::parallelFor(mesh, 1, *this);
+      sum = count = max = 0;
+      for (size_t i = 0; i < sums.size(); ++i) {
+        sum += sums[i];
+        count += counts[i];
+        if (maxima[i] > max)
+          max = maxima[i];
+      }
+    }
+    double sum;
+    double count;
+    double max;
+  private:
+    Mesh* mesh;
+    IdentitySizeField sizeField;
+    bool onlyOwned;
+    std::vector<double> sums;
+    std::vector<double> counts;
+    std::vector<double> maxima;
+};
+
 double getAverageEdgeLength(Mesh* m)
 {
-  IdentitySizeField sizeField(m);
+  EdgeLengthOp op(m, false);
+  op.run();
   double sums[2];
   double& length_sum = sums[0];
   double& edge_count = sums[1];
-  length_sum = edge_count = 0;
-  apf::MeshIterator* it = m->begin(1);
-  Entity* e;
-  while ((e = m->iterate(it)))
-  {
-    length_sum += sizeField.measure(e);
-    edge_count += 1.0;
-  }
-  m->end(it);
+  length_sum = op.sum;
+  edge_count = op.count;
   PCU_Add_Doubles(sums,2);
   return length_sum / edge_count;
 }
 
 double getMaximumEdgeLength(Mesh* m, SizeField* sf)
 {
-  if (!sf)
-    sf = new IdentitySizeField(m);
   double maxLength = 0.0;
-  apf::MeshIterator* it = m->begin(1);
-  Entity* e;
-  while ((e = m->iterate(it)))
-  {
-    if (!m->isOwned(e))
-      continue;
-    double length = sf->measure(e);
-    if (length > maxLength)
-      maxLength = length;
+  if (!sf) {
+    EdgeLengthOp op(m, true);
+    op.run();
+    maxLength = op.max;
+  } else {
+    Entity* edges[EDGE_BATCH];
+    double lengths[EDGE_BATCH];
+    int n = 0;
+    apf::MeshIterator* it = m->begin(1);
+    Entity* e;
+    do {
+      e = m->iterate(it);
+      if (e && m->isOwned(e))
+        edges[n++] = e;
+      if (n == EDGE_BATCH || (n && !e)) {
+        sf->measureEdges(edges, n, lengths);
+        for (int i = 0; i < n; ++i)
+          if (lengths[i] > maxLength)
+            maxLength = lengths[i];
+        n = 0;
+      }
+    } while (e);
+    m->end(it);
   }
-  m->end(it);
   PCU_Max_Doubles(&maxLength,1);
   return maxLength;
 }
 
-
 }
@@ -36,6 +36,18 @@ class SizeField
         Vector const& xi,
         Matrix& t) = 0;
     virtual double getWeight(Entity* e) = 0;
+    /** \brief measure n edges at once into lengths
+      \details the default calls measure on each edge */
+    virtual void measureEdges(Entity** edges, int n, double* lengths);
+    /** \brief measure straight edges from the metrics at their vertices
+      \details anisotropic size fields on linear MDS meshes then measure
+      an edge in closed form, interpolating the lengths given by the
+      metrics of its two vertices geometrically along it, instead of
+      integrating the metric. This is much faster but gives slightly
+      different lengths. Their measure then fills a vertex metric cache
+      owned by the size field, so it must not be called from several
+      threads at once. The default ignores this. */
+    virtual void setClosedFormEdges(bool on);
 };
 
 struct IdentitySizeField : public SizeField
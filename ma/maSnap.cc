@@ -10,6 +10,7 @@
 #include <PCU.h>
 #include "maSnap.h"
 #include "maAdapt.h"
+#include "maProfile.h"
 #include "maOperator.h"
 #include "maSnapper.h"
 #include "maMatchedSnapper.h"
@@ -720,15 +721,6 @@ void transferToClosestPointOnQuadSplit(
   (void) targetPt;
 }
 
-static void getSnapPoint(Mesh* m, Entity* v, Vector& x)
-{
-  m->getPoint(v,0,x);
-  Vector p;
-  m->getParam(v,p);
-  Model* g = m->toModel(v);
-  m->snapToModel(g,p,x);
-}
-
 class SnapAll : public Operator
 {
   public:
@@ -775,6 +767,7 @@ bool snapAllVerts(Adapt* a, Tag* t, bool isSimple, long& successCount)
 {
   SnapAll op(a, t, isSimple);
   applyOperator(a, &op);
+  countOperations(a, 0, op.successCount);
   successCount += PCU_Add_Long(op.successCount);
   return PCU_Or(op.didAnything);
 }
@@ -826,32 +819,78 @@ bool snapMatchedVerts(Adapt* a, Tag* t, bool isSimple, long& successCount)
 {
   SnapMatched op(a, t, isSimple);
   applyOperator(a, &op);
+  countOperations(a, 0, op.successCount);
   successCount += PCU_Add_Long(op.successCount);
   return PCU_Or(op.didAnything);
 }
 
+/* boundary vertices are evaluated in batches of this many,
+   so the model can amortize its work over them */
+enum { SNAP_BATCH = 1024 };
+
+/* computes the snap targets once. the rounds of snapping
+   read them back from the tag instead of the model */
+class SnapTargets
+{
+  public:
+    SnapTargets(Mesh* m, Tag* t):
+      mesh(m),
+      tag(t),
+      count(0),
+      tagged(0)
+    {
+    }
+    void add(Entity* v)
+    {
+      verts[count] = v;
+      models[count] = mesh->toModel(v);
+      mesh->getParam(v, params[count]);
+      if (++count == SNAP_BATCH)
+        flush();
+    }
+    void flush()
+    {
+      mesh->snapToModel(count, models, params, points);
+      for (int i = 0; i < count; ++i) {
+        Vector x = getPosition(mesh, verts[i]);
+        if (apf::areClose(points[i], x, 1e-12))
+          continue;
+        mesh->setDoubleTag(verts[i], tag, &points[i][0]);
+        if (mesh->isOwned(verts[i]))
+          ++tagged;
+      }
+      count = 0;
+    }
+    long getTagged() {return tagged;}
+  private:
+    Mesh* mesh;
+    Tag* tag;
+    int count;
+    long tagged;
+    Entity* verts[SNAP_BATCH];
+    Model* models[SNAP_BATCH];
+    Vector params[SNAP_BATCH];
+    Vector points[SNAP_BATCH];
+};
+
 long tagVertsToSnap(Adapt* a, Tag*& t)
 {
   Mesh* m = a->mesh;
   int dim = m->getDimension();
   t = m->createDoubleTag("ma_snap", 3);
+  SnapTargets* targets = new SnapTargets(m, t);
   Entity* v;
-  long n = 0;
   Iterator* it = m->begin(0);
   while ((v = m->iterate(it))) {
     int md = m->getModelType(m->toModel(v));
     if (dim == 3 && md == 3)
       continue;
-    Vector s;
-    getSnapPoint(m, v, s);
-    Vector x = getPosition(m, v);
-    if (apf::areClose(s, x, 1e-12))
-      continue;
-    m->setDoubleTag(v, t, &s[0]);
-    if (m->isOwned(v))
-      ++n;
+    targets->add(v);
   }
   m->end(it);
+  targets->flush();
+  long n = targets->getTagged();
+  delete targets;
   return PCU_Add_Long(n);
 }
 
@@ -897,6 +936,7 @@ void snap(Adapt* a)
 {
   if ( ! a->input->shouldSnap)
     return;
+  Stage stage(a, "snap");
   double t0 = PCU_Time();
   Tag* tag;
   /* we are starting to support a few operations on matched
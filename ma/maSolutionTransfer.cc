@@ -12,7 +12,12 @@
 #include "maMap.h"
 #include <apfShape.h>
 #include <apfNumbering.h>
+#include <apfField.h>
+#include <apfFieldData.h>
+#include <pcu_util.h>
 #include <float.h>
+#include <algorithm>
+#include <map>
 
 namespace ma {
 
@@ -63,15 +68,35 @@ int SolutionTransfer::getTransferDimension()
   return transferDimension;
 }
 
-class FieldTransfer : public SolutionTransfer
+/* a transfer that more fields of the same shape can join */
+class ShapeTransfer : public SolutionTransfer
+{
+  public:
+    virtual void add(apf::Field* f) = 0;
+};
+
+/* fields with the same shape have their nodes in the same
+   places, so one of these transfers all of them with one
+   shape function evaluation per new node. the nodal values of
+   an element are interleaved so that all the components of a
+   node are contiguous and get interpolated in a single loop. */
+class FieldTransfer : public ShapeTransfer
 {
   public:
     FieldTransfer(apf::Field* f)
     {
-      field = f;
       mesh = apf::getMesh(f);
       shape = apf::getShape(f);
-      value.allocate(apf::countComponents(f));
+      components = 0;
+      add(f);
+    }
+    virtual void add(apf::Field* f)
+    {
+      PCU_ALWAYS_ASSERT(apf::getShape(f) == shape);
+      fields.push_back(f);
+      offsets.push_back(components);
+      components += apf::countComponents(f);
+      value.allocate(components);
     }
     /* hmm... in vs. on ... probably the ma:: signature
        should change, it has the least users */
@@ -79,10 +104,52 @@ class FieldTransfer : public SolutionTransfer
     {
       return shape->hasNodesIn(dimension);
     }
-    apf::Field* field;
+    int countElementValues(Entity* e)
+    {
+      return shape->getEntityShape(mesh->getType(e))->countNodes()
+        * components;
+    }
+    void gather(Entity* e, double* data)
+    {
+      for (size_t i = 0; i < fields.size(); ++i)
+      {
+        int nc = apf::countComponents(fields[i]);
+        int n = fields[i]->getData()->getElementData(e,nodeData) / nc;
+        for (int j = 0; j < n; ++j)
+          for (int k = 0; k < nc; ++k)
+            data[j * components + offsets[i] + k] = nodeData[j * nc + k];
+      }
+    }
+    void interpolate(
+        Entity* e,
+        double const* data,
+        Vector const& xi,
+        apf::Node const& node)
+    {
+      shape->getEntityShape(mesh->getType(e))->getValues(
+          mesh,e,xi,shapeValues);
+      int nen = shapeValues.size();
+      for (int k = 0; k < components; ++k)
+        value[k] = 0;
+      for (int j = 0; j < nen; ++j)
+      {
+        double s = shapeValues[j];
+        double const* d = data + j * components;
+        for (int k = 0; k < components; ++k)
+          value[k] += s * d[k];
+      }
+      for (size_t i = 0; i < fields.size(); ++i)
+        apf::setComponents(fields[i],node.entity,node.node,
+            &(value[offsets[i]]));
+    }
     apf::Mesh* mesh;
     apf::FieldShape* shape;
+    std::vector<apf::Field*> fields;
+    std::vector<int> offsets;
+    int components;
     apf::NewArray<double> value;
+    apf::NewArray<double> nodeData;
+    apf::NewArray<double> shapeValues;
 };
 
 class LinearTransfer : public FieldTransfer
@@ -97,11 +164,13 @@ class LinearTransfer : public FieldTransfer
         Vector const& xi, 
         Entity* vert)
     {
-      apf::Element* e = apf::createElement(field,parent);
-      apf::getComponents(e,xi,&(value[0]));
-      apf::setComponents(field,vert,0,&(value[0]));
-      apf::destroyElement(e);
+      Entity* e = apf::getMeshEntity(parent);
+      elementData.allocate(countElementValues(e));
+      gather(e,&(elementData[0]));
+      interpolate(e,&(elementData[0]),xi,apf::Node(vert,0));
     }
+  private:
+    apf::NewArray<double> elementData;
 };
 
 class CavityTransfer : public FieldTransfer
@@ -112,17 +181,9 @@ class CavityTransfer : public FieldTransfer
     {
       minDim = getMinimumDimension(getShape(f));
     }
-    void transferToNodeIn(
-        apf::Element* elem,
-        apf::Node const& node,
-        Vector const& elemXi)
-    {
-      apf::getComponents(elem,elemXi,&(value[0]));
-      apf::setComponents(field,node.entity,node.node,&(value[0]));
-    }
     int getBestElement(
         int n,
-        apf::Element** elems,
+        Entity** cavity,
         Affine* elemInvMaps,
         Vector const& point,
         Vector& bestXi)
@@ -132,7 +193,7 @@ class CavityTransfer : public FieldTransfer
       for (int i = 0; i < n; ++i)
       {
         Vector xi = elemInvMaps[i] * point;
-        double value = getInsideness(mesh,apf::getMeshEntity(elems[i]),xi);
+        double value = getInsideness(mesh,cavity[i],xi);
         if (value > bestValue)
         {
           bestValue = value;
@@ -144,8 +205,9 @@ class CavityTransfer : public FieldTransfer
     }
     void transferToNode(
         int n,
-        apf::Element** elems,
+        Entity** cavity,
         Affine* elemInvMaps,
+        int stride,
         apf::Node const& node)
     {
       Vector xi;
@@ -153,8 +215,8 @@ class CavityTransfer : public FieldTransfer
       Affine childMap = getMap(mesh,node.entity);
       Vector point = childMap * xi;
       Vector elemXi;
-      int i = getBestElement(n,elems,elemInvMaps,point,elemXi);
-      transferToNodeIn(elems[i],node,elemXi);
+      int i = getBestElement(n,cavity,elemInvMaps,point,elemXi);
+      interpolate(cavity[i],&(cavityData[i * stride]),elemXi,node);
     }
     void transfer(
         int n,
@@ -163,9 +225,12 @@ class CavityTransfer : public FieldTransfer
     {
       if (getDimension(mesh, cavity[0]) < minDim)
         return;
-      apf::NewArray<apf::Element*> elems(n);
+      int stride = 0;
+      for (int i = 0; i < n; ++i)
+        stride = std::max(stride,countElementValues(cavity[i]));
+      cavityData.allocate(n * stride);
       for (int i = 0; i < n; ++i)
-        elems[i] = apf::createElement(field,cavity[i]);
+        gather(cavity[i],&(cavityData[i * stride]));
       apf::NewArray<Affine> elemInvMaps(n);
       for (int i = 0; i < n; ++i)
         elemInvMaps[i] = invert(getMap(mesh,cavity[i]));
@@ -178,11 +243,9 @@ class CavityTransfer : public FieldTransfer
         for (int j = 0; j < nnodes; ++j)
         {
           apf::Node node(newEntities[i],j);
-          transferToNode(n,&(elems[0]),&(elemInvMaps[0]),node);
+          transferToNode(n,cavity,&(elemInvMaps[0]),stride,node);
         }
       }
-      for (int i = 0; i < n; ++i)
-        apf::destroyElement(elems[i]);
     }
     virtual void onRefine(
         Entity* parent,
@@ -198,6 +261,7 @@ class CavityTransfer : public FieldTransfer
     }
   private:
     int minDim;
+    apf::NewArray<double> cavityData;
 };
 
 /* hmm... could use multiple inheritance here, but that creates
@@ -212,7 +276,7 @@ class CavityTransfer : public FieldTransfer
    and I don't want to reason about how
    stable it will be in this case.
    There are few transfer objects, so having duplicates is not too bad */
-class HighOrderTransfer : public SolutionTransfer
+class HighOrderTransfer : public ShapeTransfer
 {
   public:
     LinearTransfer verts;
@@ -221,6 +285,11 @@ class HighOrderTransfer : public SolutionTransfer
       verts(f),others(f)
     {
     }
+    virtual void add(apf::Field* f)
+    {
+      verts.add(f);
+      others.add(f);
+    }
     virtual bool hasNodesOn(int dimension)
     {
       return others.hasNodesOn(dimension);
@@ -246,7 +315,7 @@ class HighOrderTransfer : public SolutionTransfer
     }
 };
 
-SolutionTransfer* createFieldTransfer(apf::Field* f)
+static ShapeTransfer* createShapeTransfer(apf::Field* f)
 {
   apf::FieldShape* shape = apf::getShape(f);
   if (shape->hasNodesIn(0))
@@ -260,6 +329,11 @@ SolutionTransfer* createFieldTransfer(apf::Field* f)
   return new CavityTransfer(f);
 }
 
+SolutionTransfer* createFieldTransfer(apf::Field* f)
+{
+  return createShapeTransfer(f);
+}
+
 SolutionTransfers::SolutionTransfers()
 {
 }
@@ -310,10 +384,18 @@ void SolutionTransfers::onCavity(
 
 AutoSolutionTransfer::AutoSolutionTransfer(Mesh* m)
 {
+  std::map<apf::FieldShape*, ShapeTransfer*> byShape;
   for (int i = 0; i < m->countFields(); ++i)
   {
     apf::Field* f = m->getField(i);
-    this->add(createFieldTransfer(f));
+    apf::FieldShape* s = apf::getShape(f);
+    if (byShape.count(s))
+      byShape[s]->add(f);
+    else
+    {
+      byShape[s] = createShapeTransfer(f);
+      this->add(byShape[s]);
+    }
   }
 }
 
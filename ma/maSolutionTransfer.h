@@ -106,8 +106,10 @@ class SolutionTransfers : public SolutionTransfer
 };
 
 /** \brief MeshAdapt's automatic solution transfer system.
-  \details will call ma::createFieldTransfer on all fields associated
-  with the mesh and put them together. */
+  \details will create a transfer for all fields associated
+  with the mesh and put them together. Fields that share an
+  apf::FieldShape are transferred by one object, which evaluates
+  the shape functions once per new node for all of them. */
 class AutoSolutionTransfer : public SolutionTransfers
 {
   public:
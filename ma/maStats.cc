@@ -6,6 +6,12 @@
  */
 #include "maStats.h"
 #include "maAdapt.h"
+#include <apfShape.h>
+#include <apfThreads.h>
+#include <PCU.h>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
 
 namespace ma {
 
@@ -86,11 +92,10 @@ void getEdgeLengthsInPhysicalSpace(ma::Mesh* m,
 {
   ma::Entity* e;
   ma::Iterator* it;
+  IdentitySizeField sf(m);
   it = m->begin(1);
-  while( (e = m->iterate(it)) ) {
-    SizeField* sf = new IdentitySizeField(m);
-    edgeLengths.push_back(sf->measure(e));
-  }
+  while( (e = m->iterate(it)) )
+    edgeLengths.push_back(sf.measure(e));
   m->end(it);
 }
 
@@ -134,4 +139,274 @@ void stats(ma::Mesh* m, ma::SizeField* sf,
     getStatsInPhysicalSpace(m, edgeLengths, linearQualities);
 }
 
+Histogram::Histogram(double l, double h, int n):
+  low(l),
+  high(h),
+  bins(n, 0.0),
+  count(0),
+  sum(0),
+  min(DBL_MAX),
+  max(-DBL_MAX)
+{
+  PCU_ALWAYS_ASSERT(n > 0 && h > l);
+}
+
+void Histogram::add(double x)
+{
+  /* NaN would make the bin index undefined */
+  if (!std::isfinite(x))
+    return;
+  int n = bins.size();
+  /* clamp before converting, far values overflow an int */
+  double t = (x - low) / (high - low) * n;
+  int i = t < 0 ? 0 : (t < n - 1 ? int(t) : n - 1);
+  bins[i] += 1;
+  count += 1;
+  sum += x;
+  min = std::min(min, x);
+  max = std::max(max, x);
+}
+
+void Histogram::merge(Histogram const& other)
+{
+  PCU_ALWAYS_ASSERT(other.bins.size() == bins.size());
+  for (size_t i = 0; i < bins.size(); ++i)
+    bins[i] += other.bins[i];
+  count += other.count;
+  sum += other.sum;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+}
+
+double Histogram::getMean() const
+{
+  return count ? sum / count : 0;
+}
+
+double Histogram::getBinLow(int i) const
+{
+  return low + (high - low) * i / bins.size();
+}
+
+double Histogram::getPercentile(double p) const
+{
+  if (!count)
+    return 0;
+  double target = p / 100 * count;
+  double below = 0;
+  int n = bins.size();
+  int i = 0;
+  for (; i < n - 1; ++i) {
+    if (below + bins[i] >= target)
+      break;
+    below += bins[i];
+  }
+  double fraction = bins[i] ? (target - below) / bins[i] : 0;
+  double x = getBinLow(i) + fraction * (high - low) / n;
+  return std::max(min, std::min(max, x));
+}
+
+void reduceHistograms(Histogram* h[], int n)
+{
+  /* the sums of all the histograms go in one reduction and their
+     extrema in another, which are in flight at the same time */
+  std::vector<double> sums;
+  std::vector<double> extrema;
+  for (int i = 0; i < n; ++i) {
+    sums.push_back(h[i]->count);
+    sums.push_back(h[i]->sum);
+    sums.insert(sums.end(), h[i]->bins.begin(), h[i]->bins.end());
+    extrema.push_back(-h[i]->min);
+    extrema.push_back(h[i]->max);
+  }
+  if (!n)
+    return;
+  PCU_Request requests[2];
+  PCU_Iadd_Doubles(&sums[0], sums.size(), &requests[0]);
+  PCU_Imax_Doubles(&extrema[0], extrema.size(), &requests[1]);
+  PCU_Wait(&requests[0]);
+  PCU_Wait(&requests[1]);
+  size_t k = 0;
+  for (int i = 0; i < n; ++i) {
+    h[i]->count = sums[k++];
+    h[i]->sum = sums[k++];
+    for (size_t j = 0; j < h[i]->bins.size(); ++j)
+      h[i]->bins[j] = sums[k++];
+    h[i]->min = -extrema[i * 2];
+    h[i]->max = extrema[i * 2 + 1];
+  }
+}
+
+/* the size field may not be safe to evaluate from several
+   threads, so its transform at each vertex is stored first
+   and the threads only read the mesh and this tag */
+static Tag* tagVertexTransforms(Mesh* m, SizeField* sf)
+{
+  Tag* t = m->createDoubleTag("ma_stats_transform", 9);
+  Entity* v;
+  Iterator* it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::MeshElement* me = apf::createMeshElement(m, v);
+    Matrix Q;
+    sf->getTransform(me, Vector(0, 0, 0), Q);
+    apf::destroyMeshElement(me);
+    double q[9];
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        q[i * 3 + j] = Q[i][j];
+    m->setDoubleTag(v, t, q);
+  }
+  m->end(it);
+  return t;
+}
+
+/* the linear quality of owned simplex elements from their vertex
+   points and transforms, with the identity when there is no tag */
+class QualityHistogramOp : public apf::ParallelOp
+{
+  public:
+    QualityHistogramOp(Mesh* m, Tag* t, Histogram const& empty):
+      histograms(apf::getThreadCount(), empty),
+      mesh(m),
+      transforms(t)
+    {
+    }
+    void getTransform(Entity* v, Matrix& Q)
+    {
+      if (!transforms) {
+        Q = Matrix(1, 0, 0, 0, 1, 0, 0, 0, 1);
+        return;
+      }
+      double q[9];
+      mesh->getDoubleTag(v, transforms, q);
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          Q[i][j] = q[i * 3 + j];
+    }
+    void apply(Entity* e, int thread)
+    {
+      if (!mesh->isOwned(e))
+        return;
+      int type = mesh->getType(e);
+      if (!apf::isSimplex(type))
+        return;
+      Entity* v[4];
+      int n = mesh->getDownward(e, 0, v);
+      Vector x[4];
+      Matrix Q[4];
+      for (int i = 0; i < n; ++i) {
+        x[i] = getPosition(mesh, v[i]);
+        getTransform(v[i], Q[i]);
+      }
+      double lq;
+      if (type == apf::Mesh::TET)
+        lq = cbrt(measureLinearTetQuality(x, Q));
+      else {
+        lq = std::sqrt(measureLinearTriQuality(x, Q, mesh->getDimension()));
+        /* in physical space planar triangles keep their orientation */
+        if (!transforms && apf::cross(x[1] - x[0], x[2] - x[0])[2] < 0)
+          lq = -lq;
+      }
+      histograms[thread].add(lq);
+    }
+    std::vector<Histogram> histograms;
+  private:
+    Mesh* mesh;
+    Tag* transforms;
+};
+
+/* the identity size field is purely geometric,
+   so physical edge lengths are measured on threads */
+class EdgeLengthHistogramOp : public apf::ParallelOp
+{
+  public:
+    EdgeLengthHistogramOp(Mesh* m, Histogram const& empty):
+      histograms(apf::getThreadCount(), empty),
+      mesh(m),
+      sizeField(m)
+    {
+    }
+    void apply(Entity* e, int thread)
+    {
+      if (mesh->isOwned(e))
+        histograms[thread].add(sizeField.measure(e));
+    }
+    std::vector<Histogram> histograms;
+  private:
+    Mesh* mesh;
+    IdentitySizeField sizeField;
+};
+
+static void mergeAll(Histogram& into, std::vector<Histogram> const& from)
+{
+  for (size_t i = 0; i < from.size(); ++i)
+    into.merge(from[i]);
+}
+
+static void addQualities(Mesh* m, SizeField* sf, Histogram& h, bool inMetric)
+{
+  /* curved elements need the full measure, one at a time */
+  if (inMetric && m->getShape()->getOrder() != 1) {
+    std::vector<double> lq;
+    getLinearQualitiesInMetricSpace(m, sf, lq);
+    for (size_t i = 0; i < lq.size(); ++i)
+      h.add(lq[i]);
+    return;
+  }
+  Tag* t = inMetric ? tagVertexTransforms(m, sf) : 0;
+  QualityHistogramOp op(m, t, Histogram(h.getBinLow(0),
+        h.getBinLow(h.countBins()), h.countBins()));
+  apf::parallelFor(m, m->getDimension(), op);
+  mergeAll(h, op.histograms);
+  if (t) {
+    apf::removeTagFromDimension(m, t, 0);
+    m->destroyTag(t);
+  }
+}
+
+static void addEdgeLengths(Mesh* m, SizeField* sf, Histogram& h,
+    bool inMetric)
+{
+  if (!inMetric) {
+    EdgeLengthHistogramOp op(m, Histogram(h.getBinLow(0),
+          h.getBinLow(h.countBins()), h.countBins()));
+    apf::parallelFor(m, 1, op);
+    mergeAll(h, op.histograms);
+    return;
+  }
+  /* metric lengths go through the size field in batches,
+     which measures cached edges in closed form */
+  enum { BATCH = 256 };
+  Entity* edges[BATCH];
+  double lengths[BATCH];
+  int n = 0;
+  Entity* e;
+  Iterator* it = m->begin(1);
+  while (true) {
+    e = m->iterate(it);
+    if (e && m->isOwned(e))
+      edges[n++] = e;
+    if (n == BATCH || (!e && n)) {
+      sf->measureEdges(edges, n, lengths);
+      for (int i = 0; i < n; ++i)
+        h.add(lengths[i]);
+      n = 0;
+    }
+    if (!e)
+      break;
+  }
+  m->end(it);
+}
+
+void stats(ma::Mesh* m, ma::SizeField* sf,
+    Histogram& edgeLengths,
+    Histogram& linearQualities,
+    bool inMetric)
+{
+  addEdgeLengths(m, sf, edgeLengths, inMetric);
+  addQualities(m, sf, linearQualities, inMetric);
+  Histogram* h[2] = {&edgeLengths, &linearQualities};
+  reduceHistograms(h, 2);
+}
+
 }
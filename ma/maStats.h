@@ -44,5 +44,55 @@ void stats(ma::Mesh* m, ma::SizeField* sf,
     std::vector<double> &linearQualities,
     bool inMetric);
 
+/** \brief a streaming summary of a distribution of values
+  \details the count, mean and extrema are exact, the rest of
+  the distribution is kept in equal bins over [low, high].
+  values outside that range are counted in the first or last bin. */
+class Histogram
+{
+  public:
+    /** \brief an empty histogram of (bins) equal bins from
+      (low) to (high), which must be more than (low) */
+    Histogram(double low, double high, int bins);
+    /** \brief count a value, ignoring infinite and NaN ones */
+    void add(double x);
+    /** \brief add the values of a histogram with the same bins */
+    void merge(Histogram const& other);
+    double getCount() const {return count;}
+    double getMin() const {return min;}
+    double getMax() const {return max;}
+    double getMean() const;
+    /** \brief estimates the value below which (p) percent of
+      the values fall, interpolating within its bin */
+    double getPercentile(double p) const;
+    int countBins() const {return bins.size();}
+    double getBinCount(int i) const {return bins[i];}
+    double getBinLow(int i) const;
+  private:
+    friend void reduceHistograms(Histogram* h[], int n);
+    double low;
+    double high;
+    std::vector<double> bins;
+    double count;
+    double sum;
+    double min;
+    double max;
+};
+
+/** \brief sums (n) histograms over all parts
+  \details every part must give the same histograms in the same order */
+void reduceHistograms(Histogram* h[], int n);
+
+/** \brief measures the statistics of ma::stats into histograms
+  \details the owned entities of all parts are added to the
+  histograms, which should start out empty. the size field is
+  evaluated once per vertex and the element qualities are then
+  computed on apf::getThreadCount() threads, without storing a
+  value per entity. */
+void stats(ma::Mesh* m, ma::SizeField* sf,
+    Histogram& edgeLengths,
+    Histogram& linearQualities,
+    bool inMetric);
+
 }
 #endif
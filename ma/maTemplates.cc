@@ -657,4 +657,20 @@ SplitFunction tet_templates[tet_edge_code_count] =
 ,splitTet_6    //11
 };
 
+/* pyramids make two tets and prisms three */
+int const tet_template_tets[tet_edge_code_count] =
+{1
+,2 // 1
+,3 // 2_1: tet and pyramid
+,4 // 2_2
+,4 // 3_1: tet, tet and pyramid
+,5 // 3_2: two pyramids and a tet
+,5 // 3_3: two pyramids and a tet
+,4 // 3_4: tet and prism
+,6 // 4_1: two tets and two pyramids
+,6 // 4_2: two prisms
+,7 // 5: prism, pyramid and two tets
+,8 // 6
+};
+
 }
@@ -31,6 +31,10 @@ extern SplitFunction quad_templates[quad_edge_code_count];
 extern SplitFunction prism_templates[prism_edge_code_count];
 extern SplitFunction pyramid_templates[pyramid_edge_code_count];
 
+/* the number of tets made by each of tet_templates,
+   unless a prism in it needs a centroid vertex */
+extern int const tet_template_tets[tet_edge_code_count];
+
 }
 
 #endif
@@ -3,6 +3,7 @@
 #include "maTetrahedronize.h"
 #include "maCrawler.h"
 #include "maAdapt.h"
+#include "maProfile.h"
 #include "maRefine.h"
 #include "maLayer.h"
 #include <apfNumbering.h>
@@ -498,6 +499,7 @@ void tetrahedronize(Adapt* a)
   if ( ! a->input->shouldTurnLayerToTets)
     return;
   PCU_ALWAYS_ASSERT(a->hasLayer);
+  Stage stage(a, "tetrahedronize");
   double t0 = PCU_Time();
   prepareLayerToTets(a);
   Refine* r = a->refine;
@@ -673,6 +675,7 @@ void cleanupLayer(Adapt* a)
     return;
   if (!a->input->shouldCleanupLayer)
     return;
+  Stage stage(a, "cleanupLayer");
   double t0 = PCU_Time();
   long n = prepareIslandCleanup(a);
   if (!n) {
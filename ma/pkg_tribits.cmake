@@ -46,6 +46,7 @@ set(SOURCES
   maExtrude.cc
   maDBG.cc
   maStats.cc
+  maProfile.cc
 )
 
 set(HEADERS
@@ -19,6 +19,8 @@
 #include <apfNumbering.h>
 #include <apfPartition.h>
 #include <apfFile.h>
+#include <apfField.h>
+#include <apfTagData.h>
 #include <cstring>
 #include <pcu_util.h>
 #include <cstdlib>
@@ -106,26 +108,40 @@ static mds_id fromEnt(MeshEntity* e)
   return (reinterpret_cast<char*>(e) - ((char*)1));
 }
 
-static MeshIterator* makeIter()
+/* the current entity and the position at which iteration stops,
+   which is MDS_NONE unless iterating over a range */
+struct IterMDS
 {
-  mds_id* p = new mds_id;
+  mds_id id;
+  mds_id stop;
+};
+
+static MeshIterator* makeIter(mds_id stop = MDS_NONE)
+{
+  IterMDS* p = new IterMDS;
+  p->stop = stop;
   return reinterpret_cast<MeshIterator*>(p);
 }
 
 static void freeIter(MeshIterator* it)
 {
-  mds_id* p = reinterpret_cast<mds_id*>(it);
+  IterMDS* p = reinterpret_cast<IterMDS*>(it);
   delete p;
 }
 
 static void toIter(mds_id id, MeshIterator* it)
 {
-  *(reinterpret_cast<mds_id*>(it)) = id;
+  reinterpret_cast<IterMDS*>(it)->id = id;
 }
 
 static mds_id fromIter(MeshIterator* it)
 {
-  return *(reinterpret_cast<mds_id*>(it));
+  return reinterpret_cast<IterMDS*>(it)->id;
+}
+
+static mds_id stopIter(MeshIterator* it)
+{
+  return reinterpret_cast<IterMDS*>(it)->stop;
 }
 
 static Mesh::Type mds2apf(int t_mds)
@@ -166,12 +182,13 @@ class MeshMDS : public Mesh2
       mesh = 0;
       isMatched = false;
       ownsModel = false;
+      ghostsInterned = false;
     }
     MeshMDS(gmi_model* m, int d, bool isMatched_)
     {
       init(apf::getLagrange(1));
       mds_id cap[MDS_TYPES] = {};
-      mesh = mds_apf_create(m, d, cap);
+      setNative(mds_apf_create(m, d, cap));
       isMatched = isMatched_;
       ownsModel = true;
     }
@@ -189,7 +206,7 @@ class MeshMDS : public Mesh2
       cap[MDS_TETRAHEDRON] = countEntitiesOfType(from,TET);
       cap[MDS_HEXAHEDRON] = countEntitiesOfType(from,HEX);
       int d = from->getDimension();
-      mesh = mds_apf_create(m,d,cap);
+      setNative(mds_apf_create(m,d,cap));
       isMatched = from->hasMatching();
       ownsModel = true;
       apf::convert(from, this, nodes, elems, copy_data);
@@ -198,7 +215,7 @@ class MeshMDS : public Mesh2
     MeshMDS(gmi_model* m, const char* pathname)
     {
       init(apf::getLagrange(1));
-      mesh = mds_read_smb(m, pathname, 0, this);
+      setNative(mds_read_smb(m, pathname, 0, this));
       isMatched = PCU_Or(!mds_net_empty(&mesh->matches));
       ownsModel = true;
     }
@@ -226,13 +243,21 @@ class MeshMDS : public Mesh2
       toIter(id,it);
       return it;
     }
+    MeshIterator* beginRange(int dimension, int range, int ranges)
+    {
+      mds_id stop;
+      mds_id id = mds_begin_range(&(mesh->mds),dimension,range,ranges,&stop);
+      MeshIterator* it = makeIter(stop);
+      toIter(id,it);
+      return it;
+    }
     MeshEntity* iterate(MeshIterator* it)
     {
       mds_id id = fromIter(it);
       if (id == MDS_NONE)
         return 0;
       MeshEntity* e = toEnt(id);
-      id = mds_next(&(mesh->mds),id);
+      id = mds_next_range(&(mesh->mds),id,stopIter(it));
       toIter(id,it);
       return e;
     }
@@ -264,25 +289,77 @@ class MeshMDS : public Mesh2
     {
       return mds_get_copies(&mesh->remotes, fromEnt(e));
     }
+    /* every replacement of the mds_apf goes through here, since
+       a new one (from a reorder, read or write) starts with
+       clear ghost bits */
+    void setNative(mds_apf* m)
+    {
+      mesh = m;
+      ghostsInterned = false;
+    }
+    static bool isGhostTagName(const char* name)
+    {
+      return !strcmp(name, "ghost_tag") || !strcmp(name, "ghosted_tag");
+    }
+    /* the ghost_tag and ghosted_tag set by pumi are what tell
+       a ghost copy from a ghosted entity, so they are looked up
+       once per mds_apf and mirrored into its ghost bits as they
+       are set and removed, making these checks bit reads */
+    void internGhostTags()
+    {
+      ghostTag = mds_find_tag(&mesh->tags, "ghost_tag");
+      ghostedTag = mds_find_tag(&mesh->tags, "ghosted_tag");
+      ghostsInterned = true;
+      for (int d = 0; d <= mesh->mds.d; ++d)
+        for (mds_id id = mds_begin(&mesh->mds, d);
+             id != MDS_NONE; id = mds_next(&mesh->mds, id)) {
+          int flags = 0;
+          if (ghostTag && mds_has_tag(ghostTag, id))
+            flags |= MDS_GHOST;
+          if (ghostedTag && mds_has_tag(ghostedTag, id))
+            flags |= MDS_GHOSTED;
+          mds_apf_set_ghost(mesh, id, flags);
+        }
+    }
+    int ghostFlag(MeshTag* t)
+    {
+      if (!ghostsInterned)
+        internGhostTags();
+      mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+      if (tag == ghostTag)
+        return MDS_GHOST;
+      if (tag == ghostedTag)
+        return MDS_GHOSTED;
+      return 0;
+    }
+    void markGhost(MeshEntity* e, MeshTag* t, bool on)
+    {
+      int flag = ghostFlag(t);
+      if (!flag)
+        return;
+      mds_id id = fromEnt(e);
+      int flags = mds_apf_ghost(mesh, id);
+      mds_apf_set_ghost(mesh, id, on ? (flags | flag) : (flags & ~flag));
+    }
     bool isGhost(MeshEntity* e)
     {
-      MeshTag* t = findTag("ghost_tag");
-      if (t && hasTag(e, t))
-        return true;
-      return false;
+      if (!ghostsInterned)
+        internGhostTags();
+      return mds_apf_ghost(mesh, fromEnt(e)) & MDS_GHOST;
     }
 
     void deleteGhost(MeshEntity* e)
     {
-      mds_set_copies(&mesh->ghosts, &mesh->mds, fromEnt(e), NULL);
+      mds_id id = fromEnt(e);
+      mds_set_copies(&mesh->ghosts, &mesh->mds, id, NULL);
+      mds_apf_set_ghost(mesh, id, mds_apf_ghost(mesh, id) & ~MDS_GHOSTED);
     }
 
     bool isGhosted(MeshEntity* e)
     {
-      MeshTag* t = findTag("ghosted_tag");
-      if (t && hasTag(e, t))
-        return true;
-      return false;
+      if (!ghostsInterned)
+        internGhostTags();
+      return mds_apf_ghost(mesh, fromEnt(e)) & MDS_GHOSTED;
     }
 
     bool isOwned(MeshEntity* e)
@@ -320,6 +397,10 @@ class MeshMDS : public Mesh2
     {
       mds_set s;
       mds_id id = fromEnt(e);
+      mds_id* frozen;
+      int n = mds_get_frozen_up(&(mesh->mds),id,&frozen);
+      if (n >= 0)
+        return n;
       mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
       return s.n;
     }
@@ -327,6 +408,12 @@ class MeshMDS : public Mesh2
     {
       mds_set s;
       mds_id id = fromEnt(e);
+      mds_id* frozen;
+      int n = mds_get_frozen_up(&(mesh->mds),id,&frozen);
+      if (n >= 0) {
+        PCU_ALWAYS_ASSERT(i < n);
+        return toEnt(frozen[i]);
+      }
       mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
       PCU_ALWAYS_ASSERT(i < s.n);
       return toEnt(s.e[i]);
@@ -335,6 +422,14 @@ class MeshMDS : public Mesh2
     {
       mds_set s;
       mds_id id = fromEnt(e);
+      mds_id* frozen;
+      int n = mds_get_frozen_up(&(mesh->mds),id,&frozen);
+      if (n >= 0) {
+        up.n = n;
+        for (int i = 0; i < n; ++i)
+          up.e[i] = toEnt(frozen[i]);
+        return;
+      }
       mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
       up.n = s.n;
       for (int i = 0; i < s.n; ++i)
@@ -413,6 +508,8 @@ class MeshMDS : public Mesh2
       PCU_ALWAYS_ASSERT(!mds_find_tag(&mesh->tags, name));
       tag = mds_create_tag(&(mesh->tags),name,
           sizeof(int)*size, Mesh::INT);
+      if (isGhostTagName(name))
+        ghostsInterned = false;
       return reinterpret_cast<MeshTag*>(tag);
     }
     MeshTag* createLongTag(const char* name, int size)
@@ -433,6 +530,8 @@ class MeshMDS : public Mesh2
     {
       mds_tag* tag;
       tag = reinterpret_cast<mds_tag*>(t);
+      if (isGhostTagName(tag->name))
+        ghostsInterned = false;
       mds_destroy_tag(&(mesh->tags),tag);
     }
     void getTags(DynamicArray<MeshTag*>& tags)
@@ -481,6 +580,7 @@ class MeshMDS : public Mesh2
     void setIntTag(MeshEntity* e, MeshTag* tag, int const* data)
     {
       setTag(e,tag,data);
+      markGhost(e,tag,true);
     }
     void getLongTag(MeshEntity* e, MeshTag* tag, long* data)
     {
@@ -496,6 +596,7 @@ class MeshMDS : public Mesh2
       tag = reinterpret_cast<mds_tag*>(t);
       mds_id id = fromEnt(e);
       mds_take_tag(tag,id);
+      markGhost(e,t,false);
     }
     bool hasTag(MeshEntity* e, MeshTag* t)
     {
@@ -528,6 +629,8 @@ class MeshMDS : public Mesh2
     {
       mds_tag* tag;
       tag = reinterpret_cast<mds_tag*>(t);
+      if (isGhostTagName(tag->name) || isGhostTagName(newName))
+        ghostsInterned = false;
       mds_rename_tag(tag,newName);
     }
     /* \brief 16 bit additive checksum of a tag
@@ -584,7 +687,7 @@ class MeshMDS : public Mesh2
     void writeNative(const char* fileName)
     {
       double t0 = PCU_Time();
-      mesh = mds_write_smb(mesh, fileName, 0, this);
+      setNative(mds_write_smb(mesh, fileName, 0, this));
       double t1 = PCU_Time();
       if (!PCU_Comm_Self())
         lion_oprint(1,"mesh %s written in %f seconds\n", fileName, t1 - t0);
@@ -601,7 +704,7 @@ class MeshMDS : public Mesh2
       if (ownsModel)
         gmi_destroy(model);
       mds_apf_destroy(mesh);
-      mesh = 0;
+      setNative(0);
     }
     void verify()
     {
@@ -654,7 +757,8 @@ class MeshMDS : public Mesh2
     }
     void increment(MeshIterator* it)
     {
-      toIter(mds_next(&(mesh->mds),fromIter(it)),it);
+      mds_id id = mds_next_range(&(mesh->mds),fromIter(it),stopIter(it));
+      toIter(id,it);
     }
     bool isDone(MeshIterator* it)
     {
@@ -693,6 +797,26 @@ class MeshMDS : public Mesh2
       setResidence(e, r);
       return e;
     }
+    MeshEntity* findUpward_(int type, MeshEntity** down)
+    {
+      int t = apf2mds(type);
+      int nd = mds_degree[t][mds_dim[t] - 1];
+      mds_id from[12];
+      for (int i = 0; i < nd; ++i) {
+        if ( ! down[i])
+          return 0;
+        from[i] = fromEnt(down[i]);
+      }
+      mds_id e = mds_find_entity(&(mesh->mds), t, from);
+      if (e == MDS_NONE)
+        return 0;
+      return toEnt(e);
+    }
+    void reserve(int type, size_t n)
+    {
+      int t = apf2mds(type);
+      mds_apf_reserve(mesh, t, mesh->mds.n[t] + n);
+    }
     void destroy_(MeshEntity* e)
     {
       mds_id id = fromEnt(e);
@@ -748,7 +872,7 @@ class MeshMDS : public Mesh2
     }
     void clear_()
     {
-      mesh = mds_apf_create(mesh->user_model, mesh->mds.d, mesh->mds.n);
+      setNative(mds_apf_create(mesh->user_model, mesh->mds.d, mesh->mds.n));
     }
     double getElementBytes(int type)
     {
@@ -768,6 +892,9 @@ class MeshMDS : public Mesh2
     PM pmodel;
     bool isMatched;
     bool ownsModel;
+    bool ghostsInterned;
+    mds_tag* ghostTag;
+    mds_tag* ghostedTag;
 };
 
 Mesh2* makeEmptyMdsMesh(gmi_model* model, int dim, bool isMatched)
@@ -957,7 +1084,7 @@ void reorderMdsMesh(Mesh2* mesh, MeshTag* t)
   } else {
     vert_nums = mds_number_verts_bfs(m->mesh);
   }
-  m->mesh = mds_reorder(m->mesh, 0, vert_nums);
+  m->setNative(mds_reorder(m->mesh, 0, vert_nums));
   if (!PCU_Comm_Self())
     lion_oprint(1,"mesh reordered in %f seconds\n", PCU_Time()-t0);
 }
@@ -1275,6 +1402,192 @@ MeshEntity* getMdsEntity(Mesh2* in, int dimension, int index)
   return 0;
 }
 
+void freezeMdsAdjacencies(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_freeze(&(m->mesh->mds));
+}
+
+void unfreezeMdsAdjacencies(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_thaw(&(m->mesh->mds));
+}
+
+bool isMdsMesh(Mesh* in)
+{
+  return dynamic_cast<MeshMDS*>(in) != 0;
+}
+
+int getMdsIntTag(MeshTag* t, MeshEntity* e)
+{
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds_id id = fromEnt(e);
+  if (!mds_has_tag(tag, id))
+    return 0;
+  return *static_cast<int*>(mds_get_tag(tag, id));
+}
+
+void setMdsIntTag(Mesh2* in, MeshTag* t, MeshEntity* e, int value)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds_id id = fromEnt(e);
+  mds_give_tag(tag, &(m->mesh->mds), id);
+  *static_cast<int*>(mds_get_tag(tag, id)) = value;
+}
+
+/* entities without a value may have anything in the array,
+   which it does no harm to change */
+void clearMdsIntTagBits(Mesh2* in, MeshTag* t, int dimension, int bits)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds* mds = &(m->mesh->mds);
+  PCU_ALWAYS_ASSERT(tag->bytes == sizeof(int));
+  for (int type = 0; type < MDS_TYPES; ++type) {
+    if (mds_dim[type] != dimension || !tag->data[type])
+      continue;
+    int* values = reinterpret_cast<int*>(tag->data[type]);
+    for (mds_id i = 0; i < mds->end[type]; ++i)
+      values[i] &= ~bits;
+  }
+}
+
+bool getMdsDoubleTag(MeshTag* t, MeshEntity* e, double* value)
+{
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds_id id = fromEnt(e);
+  if (!mds_has_tag(tag, id))
+    return false;
+  *value = *static_cast<double*>(mds_get_tag(tag, id));
+  return true;
+}
+
+void setMdsDoubleTag(Mesh2* in, MeshTag* t, MeshEntity* e, double value)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds_id id = fromEnt(e);
+  mds_give_tag(tag, &(m->mesh->mds), id);
+  *static_cast<double*>(mds_get_tag(tag, id)) = value;
+}
+
+void removeMdsTag(Mesh2* in, MeshTag* t, int dimension)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds* mds = &(m->mesh->mds);
+  for (int type = 0; type < MDS_TYPES; ++type)
+    if (mds_dim[type] == dimension && tag->has[type])
+      memset(tag->has[type], 0, (mds->cap[type] / 8) + 1);
+}
+
+/* the same tags as apf::TagDataOf<double> keeps, so the values
+   grow, migrate and get reordered with the mesh as before, but
+   reached directly by type and index. the mds_tag structs stay
+   put through mds_reorder, so they are looked up only once. */
+class MdsFieldData : public FieldDataOf<double>
+{
+  public:
+    virtual void init(FieldBase* f)
+    {
+      field = f;
+      mesh = dynamic_cast<MeshMDS*>(f->getMesh());
+      PCU_ALWAYS_ASSERT_VERBOSE(mesh,
+          "MDS field storage needs an MDS mesh");
+      tagData.init(f->getName(), mesh, f->getShape(), &helper,
+          f->countComponents());
+      for (int t = 0; t < MDS_TYPES; ++t)
+        tags[t] = reinterpret_cast<mds_tag*>(
+            tagData.getTypeTag(mds2apf(t)));
+    }
+    virtual bool hasEntity(MeshEntity* e)
+    {
+      mds_id id = fromEnt(e);
+      mds_tag* tag = tags[mds_type(id)];
+      return tag && mds_has_tag(tag, id);
+    }
+    virtual void removeEntity(MeshEntity* e)
+    {
+      mds_id id = fromEnt(e);
+      mds_tag* tag = tags[mds_type(id)];
+      if (tag)
+        mds_take_tag(tag, id);
+    }
+    virtual void get(MeshEntity* e, double* data)
+    {
+      mds_id id = fromEnt(e);
+      mds_tag* tag = tags[mds_type(id)];
+      if (!tag || !mds_has_tag(tag, id)) {
+        lion_eprint(1, "expected field \"%s\" on entity type %d\n",
+            field->getName(), mesh->getType(e));
+        abort();
+      }
+      memcpy(data, mds_get_tag(tag, id), tag->bytes);
+    }
+    virtual void set(MeshEntity* e, double const* data)
+    {
+      mds_id id = fromEnt(e);
+      mds_tag* tag = tags[mds_type(id)];
+      if (!mds_has_tag(tag, id))
+        mds_give_tag(tag, &(mesh->mesh->mds), id);
+      memcpy(mds_get_tag(tag, id), data, tag->bytes);
+    }
+    virtual double* getEntityValues(MeshEntity* e)
+    {
+      mds_id id = fromEnt(e);
+      mds_tag* tag = tags[mds_type(id)];
+      if (!tag || !mds_has_tag(tag, id))
+        return 0;
+      return static_cast<double*>(mds_get_tag(tag, id));
+    }
+    virtual bool isFrozen()
+    {
+      return false;
+    }
+    virtual FieldData* clone()
+    {
+      return new MdsFieldData();
+    }
+    virtual void rename(const char* newName)
+    {
+      tagData.rename(newName);
+    }
+    double* getArray(int type, int* size)
+    {
+      int t = apf2mds(type);
+      *size = mesh->mesh->mds.end[t];
+      if (!tags[t])
+        return 0;
+      return reinterpret_cast<double*>(tags[t]->data[t]);
+    }
+  private:
+    MeshMDS* mesh;
+    TagData tagData;
+    TagHelper<double> helper;
+    mds_tag* tags[MDS_TYPES];
+};
+
+Field* createMdsField(Mesh2* m, const char* name, int valueType,
+    int components, FieldShape* shape)
+{
+  return makeField(m, name, valueType, components, shape,
+      new MdsFieldData());
+}
+
+double* getMdsFieldArray(Field* f, int type, int* size)
+{
+  MdsFieldData* data = dynamic_cast<MdsFieldData*>(f->getData());
+  PCU_ALWAYS_ASSERT(data);
+  return data->getArray(type, size);
+}
+
+int getMdsTypeIndex(MeshEntity* e)
+{
+  return mds_index(fromEnt(e));
+}
+
 void disownMdsModel(Mesh2* in)
 {
   MeshMDS* m = static_cast<MeshMDS*>(in);
@@ -1297,7 +1610,7 @@ Mesh2* loadMdsPart(gmi_model* model, const char* meshfile)
 {
   MeshMDS* m = new MeshMDS();
   m->init(apf::getLagrange(1));
-  m->mesh = mds_read_smb(model, meshfile, 1, m);
+  m->setNative(mds_read_smb(model, meshfile, 1, m));
   m->isMatched = false;
   m->ownsModel = true;
   initResidence(m, m->getDimension());
@@ -1307,7 +1620,68 @@ Mesh2* loadMdsPart(gmi_model* model, const char* meshfile)
 void writeMdsPart(Mesh2* in, const char* meshfile)
 {
   MeshMDS* m = static_cast<MeshMDS*>(in);
-  m->mesh = mds_write_smb(m->mesh, meshfile, 1, m);
+  m->setNative(mds_write_smb(m->mesh, meshfile, 1, m));
+}
+
+void writeMdsMeshCollective(Mesh2* in, const char* filename)
+{
+  double t0 = PCU_Time();
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  m->setNative(mds_write_smb_shared(m->mesh, filename, m));
+  if (!PCU_Comm_Self())
+    lion_oprint(1,"mesh %s written in %f seconds\n", filename,
+        PCU_Time() - t0);
+}
+
+static Mesh2* loadMdsBuffer(gmi_model* model, char* data, size_t size)
+{
+  MeshMDS* m = new MeshMDS();
+  m->init(apf::getLagrange(1));
+  m->setNative(mds_read_smb_buffer(model, data, size, m));
+  m->isMatched = PCU_Or(!mds_net_empty(&m->mesh->matches));
+  m->ownsModel = true;
+  initResidence(m, m->getDimension());
+  stitchMesh(m);
+  m->acceptChanges();
+  return m;
+}
+
+Mesh2* loadMdsMeshCollective(gmi_model* model, const char* filename)
+{
+  double t0 = PCU_Time();
+  int partCount = mds_smb_shared_parts(filename);
+  int peers = PCU_Comm_Peers();
+  if (partCount > peers)
+    fail("loadMdsMeshCollective: file has more parts than ranks\n");
+  apf::Contract contract(partCount, peers);
+  int self = PCU_Comm_Self();
+  bool isReader = contract.isValid(self);
+  int part = isReader ? contract(self) : -1;
+  size_t size;
+  char* data = mds_read_smb_shared(filename, part, &size);
+  Mesh2* m = 0;
+  if (partCount == peers) {
+    m = loadMdsBuffer(model, data, size);
+  } else {
+    /* readers load their parts among themselves, then the mesh
+       is expanded onto the remaining ranks */
+    MPI_Comm all = PCU_Get_Comm();
+    MPI_Comm readers;
+    MPI_Comm_split(all, isReader ? 0 : 1, isReader ? part : 0, &readers);
+    PCU_Switch_Comm(readers);
+    if (isReader)
+      m = loadMdsBuffer(model, data, size);
+    PCU_Switch_Comm(all);
+    MPI_Comm_free(&readers);
+    m = expandMdsMesh(m, model, partCount);
+  }
+  free(data);
+  if (!PCU_Comm_Self())
+    lion_oprint(1,"mesh %s loaded in %f seconds\n", filename,
+        PCU_Time() - t0);
+  printStats(m);
+  warnAboutEmptyParts(m);
+  return m;
 }
 
 
@@ -1327,7 +1701,7 @@ void mds_read_smb_meta(struct pcu_file* file, struct mds_apf* mesh,
    the mds_apf pointer needs to be connected to the MeshMDS class,
    but that is typically done right after calling mds_read_smb()
    and this code is executing as a callback during read_smb() */
-  m->mesh = mesh;
+  m->setNative(mesh);
   apf::restore_meta(file, m);
 }
 
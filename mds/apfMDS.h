@@ -41,6 +41,8 @@ class Mesh2;
 class MeshTag;
 class MeshEntity;
 class Migration;
+class Field;
+class FieldShape;
 
 /** \brief a map from global ids to vertex objects */
 typedef std::map<int, MeshEntity*> GlobalToVert;
@@ -192,6 +194,72 @@ int getMdsIndex(Mesh2* in, MeshEntity* e);
   so call apf::reorderMdsMesh after any mesh modification. */
 MeshEntity* getMdsEntity(Mesh2* in, int dimension, int index);
 
+/** \brief store upward adjacencies of an MDS mesh in compact arrays
+  \details after a mesh modification phase ends, this copies the
+  one-level upward adjacencies out of their linked lists into
+  contiguous arrays (offsets and ids) from which apf::Mesh::getUp,
+  getUpward, countUpward and getAdjacent are then served.
+  The arrays are discarded as soon as any entity is created or destroyed,
+  so mesh modification simply returns to the normal storage. */
+void freezeMdsAdjacencies(Mesh2* in);
+
+/** \brief discard the arrays built by apf::freezeMdsAdjacencies */
+void unfreezeMdsAdjacencies(Mesh2* in);
+
+/** \brief returns true if this is an MDS mesh */
+bool isMdsMesh(Mesh* in);
+
+/** \brief read a tag of one int from an MDS mesh
+  \details MDS keeps the values of a tag in arrays indexed
+  like its entities, which grow with the mesh and follow entities
+  through migration like any tag. This and the functions below
+  reach those arrays directly instead of through the virtual
+  apf::Mesh tag interface. Entities without a value read as zero. */
+int getMdsIntTag(MeshTag* tag, MeshEntity* e);
+
+/** \brief write a tag of one int to an MDS mesh
+  \details unlike apf::Mesh::setIntTag this does not update the
+  ghost state of the entity, so it is not for the pumi ghost tags */
+void setMdsIntTag(Mesh2* in, MeshTag* tag, MeshEntity* e, int value);
+
+/** \brief clear bits of a tag of one int on all entities of a dimension
+  \details this is one pass over the contiguous tag arrays */
+void clearMdsIntTagBits(Mesh2* in, MeshTag* tag, int dimension, int bits);
+
+/** \brief read a tag of one double from an MDS mesh
+  \returns false, leaving value alone, if the entity has no value */
+bool getMdsDoubleTag(MeshTag* tag, MeshEntity* e, double* value);
+
+/** \brief write a tag of one double to an MDS mesh */
+void setMdsDoubleTag(Mesh2* in, MeshTag* tag, MeshEntity* e, double value);
+
+/** \brief remove a tag from all entities of a dimension at once */
+void removeMdsTag(Mesh2* in, MeshTag* tag, int dimension);
+
+/** \brief create a field whose values MDS stores by entity index
+  \details this is apf::createGeneralField for MDS meshes. The values
+  live in the same per-type MDS arrays as before, so they grow with
+  the mesh and follow entities through migration and
+  apf::reorderMdsMesh, but they are read and written by the type and
+  index of each entity rather than through the apf::Mesh tag
+  interface, and apf::FieldDataOf::getEntityValues gives them in
+  place to apf::setComponents, apf::synchronize and the like. */
+Field* createMdsField(Mesh2* m, const char* name, int valueType,
+    int components, FieldShape* shape);
+
+/** \brief the values of an MDS field on all entities of one apf type
+  \details the n values of entity (e), where n is the number of nodes
+  the field has on (type) times its number of components, start at
+  getMdsTypeIndex(e) * n in the array, which has (size) such slots.
+  Slots of entities which were destroyed or never given values hold
+  garbage; after apf::reorderMdsMesh there are no destroyed ones.
+  The array moves when entities are created.
+  \returns zero if no entity of this type has values yet */
+double* getMdsFieldArray(Field* f, int type, int* size);
+
+/** \brief the index of an entity among the MDS slots of its type */
+int getMdsTypeIndex(MeshEntity* e);
+
 Mesh2* loadMdsFromGmsh(gmi_model* g, const char* filename);
 
 Mesh2* loadMdsFromUgrid(gmi_model* g, const char* filename);
@@ -219,6 +287,23 @@ void setMdsMatching(Mesh2* in, bool has);
 Mesh2* loadMdsPart(gmi_model* model, const char* meshfile);
 void writeMdsPart(Mesh2* m, const char* meshfile);
 
+/** \brief write all parts of an MDS mesh into one shared file
+  \details unlike apf::Mesh::writeNative, which writes one .smb file
+  per rank, this writes a single file using collective MPI-IO.
+  The file starts with a table of per-part offsets followed by
+  one block per part, each aligned to a filesystem block.
+  Must be called by all ranks. */
+void writeMdsMeshCollective(Mesh2* m, const char* filename);
+
+/** \brief load an MDS mesh written by apf::writeMdsMeshCollective
+  \details the file may have been written by fewer ranks than are
+  reading it. In that case whole parts are assigned to a subset of
+  the ranks (as apf::Contract does) and the mesh is then spread over
+  the remaining ranks with apf::expandMdsMesh, leaving some parts empty.
+  Reading a file with more parts than ranks is not supported.
+  Must be called by all ranks. */
+Mesh2* loadMdsMeshCollective(gmi_model* model, const char* filename);
+
 }
 
 #endif
@@ -236,6 +236,7 @@ static void alloc_adjacency(struct mds* m, int from_dim, int to_dim)
 void mds_remove_adjacency(struct mds* m, int from_dim, int to_dim)
 {
   mds_id zero_cap[MDS_TYPES] = {0};
+  mds_thaw(m);
   resize_adjacency(m,from_dim,to_dim,m->cap,zero_cap);
   m->mrm[from_dim][to_dim] = 0;
 }
@@ -282,6 +283,7 @@ void mds_create(struct mds* m, int d, mds_id cap[MDS_TYPES])
 void mds_destroy(struct mds* m)
 {
   int i;
+  mds_thaw(m);
   mds_id old_cap[MDS_TYPES];
   for (i = 0; i < MDS_TYPES; ++i)
     old_cap[i] = m->cap[i];
@@ -397,6 +399,20 @@ static void relate_both(struct mds* m, mds_id* down, mds_id up)
   relate_back_up(m,down,up);
 }
 
+static int look_frozen(struct mds* m, mds_id e, int d, struct mds_set* s)
+{
+  mds_id* up;
+  int i;
+  if (d != mds_dim[TYPE(e)] + 1)
+    return 0;
+  s->n = mds_get_frozen_up(m, e, &up);
+  if (s->n < 0)
+    return 0;
+  for (i = 0; i < s->n; ++i)
+    s->e[i] = up[i];
+  return 1;
+}
+
 static void look_up(struct mds* m, mds_id const e, int d, struct mds_set* s)
 {
   mds_id* n;
@@ -406,6 +422,8 @@ static void look_up(struct mds* m, mds_id const e, int d, struct mds_set* s)
   int deg;
   mds_id* es = s->e;
   mds_id** p;
+  if (m->frozen && look_frozen(m,e,d,s))
+    return;
   t = TYPE(e);
   i = INDEX(e);
   p = m->first_up[d];
@@ -494,6 +512,43 @@ static void unite(struct mds_set* s, struct mds_set* with)
   s->n = j;
 }
 
+/* finds the entity of type (t) whose one-level downward adjacencies
+   are the entities in (from), in any order, by walking the upward
+   links of from[0] in place */
+mds_id mds_find_entity(struct mds* m, int t, mds_id* from)
+{
+  int d;
+  int deg;
+  int ut;
+  mds_id i;
+  mds_id nv;
+  mds_id e;
+  struct down dn;
+  int j,k;
+  d = mds_dim[t] - 1;
+  deg = mds_degree[t][d];
+  nv = m->first_up[d + 1][TYPE(from[0])][INDEX(from[0])];
+  while (nv != MDS_NONE) {
+    ut = TYPE(nv);
+    i = INDEX(nv);
+    if (ut == t) {
+      e = ID(t, i / deg);
+      dn = reach_down(m,e,d);
+      for (j = 0; j < deg; ++j) {
+        for (k = 0; k < deg; ++k)
+          if (dn.e[k] == from[j])
+            break;
+        if (k == deg)
+          break;
+      }
+      if (j == deg)
+        return e;
+    }
+    nv = m->up[d][ut][i];
+  }
+  return MDS_NONE;
+}
+
 static mds_id common_down(struct mds* m, mds_id a, mds_id b, int d)
 {
   struct down da;
@@ -508,16 +563,24 @@ static mds_id common_down(struct mds* m, mds_id a, mds_id b, int d)
   return MDS_NONE;
 }
 
-static void grow(struct mds* m, int t)
+void mds_reserve(struct mds* m, int t, mds_id n)
 {
   int i;
   mds_id old_cap[MDS_TYPES];
+  if (n <= m->cap[t])
+    return;
+  mds_thaw(m);
   for (i = 0; i < MDS_TYPES; ++i)
     old_cap[i] = m->cap[i];
-  m->cap[t] = ((old_cap[t] + 2) * 3) / 2;
+  m->cap[t] = n;
   resize(m,old_cap);
 }
 
+static void grow(struct mds* m, int t)
+{
+  mds_reserve(m,t,((m->cap[t] + 2) * 3) / 2);
+}
+
 static mds_id fill_hole(struct mds* m, int t)
 {
   mds_id *head;
@@ -606,6 +669,7 @@ static void unrelate_ent(struct mds* m, mds_id e)
 void mds_destroy_entity(struct mds* m, mds_id e)
 {
   check_ent(m,e);
+  mds_thaw(m);
   if (TYPE(e) != MDS_VERTEX)
     unrelate_ent(m,e);
   free_ent(m,e);
@@ -621,6 +685,7 @@ void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down)
   mds_id od;
   check_ent(m, up);
   check_ent(m, down);
+  mds_thaw(m);
   ut = TYPE(up);
   ui = INDEX(up);
   dd = mds_dim[ut] - 1;
@@ -674,6 +739,7 @@ mds_id mds_create_entity(struct mds* m, int t, mds_id* from)
 {
   PCU_ALWAYS_ASSERT(0 <= t);
   PCU_ALWAYS_ASSERT(t < MDS_TYPES);
+  mds_thaw(m);
   if (t == MDS_VERTEX)
     return alloc_ent(m, t);
   return add_ent(m, t, from);
@@ -777,10 +843,61 @@ mds_id mds_next(struct mds* m, mds_id e)
   return skip(m,ID(TYPE(e),INDEX(e) + 1));
 }
 
+/* entities of one dimension are visited in order of type and then
+   index, so a position in that sequence identifies a slot (live or not)
+   and ranges of positions form disjoint pieces of the iteration */
+static mds_id at_position(struct mds* m, int d, mds_id p)
+{
+  int t;
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == d) {
+      if (p < m->end[t])
+        return ID(t,p);
+      p -= m->end[t];
+    }
+  return MDS_NONE;
+}
+
+static int precedes(mds_id e, mds_id stop)
+{
+  if (stop == MDS_NONE)
+    return 1;
+  if (TYPE(e) != TYPE(stop))
+    return TYPE(e) < TYPE(stop);
+  return INDEX(e) < INDEX(stop);
+}
+
+mds_id mds_begin_range(struct mds* m, int d, int i, int n, mds_id* stop)
+{
+  int t;
+  double total = 0;
+  mds_id e;
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == d)
+      total += m->end[t];
+  *stop = at_position(m, d, (mds_id)((total * (i + 1)) / n));
+  e = at_position(m, d, (mds_id)((total * i) / n));
+  if (e == MDS_NONE)
+    return MDS_NONE;
+  e = skip(m, e);
+  if (e == MDS_NONE || !precedes(e, *stop))
+    return MDS_NONE;
+  return e;
+}
+
+mds_id mds_next_range(struct mds* m, mds_id e, mds_id stop)
+{
+  e = mds_next(m, e);
+  if (e == MDS_NONE || !precedes(e, stop))
+    return MDS_NONE;
+  return e;
+}
+
 void mds_add_adjacency(struct mds* m, int from_dim, int to_dim)
 {
   mds_id e;
   struct mds_set adj;
+  mds_thaw(m);
   alloc_adjacency(m,from_dim,to_dim);
   if (from_dim < to_dim)
     for (e = mds_begin(m,to_dim);
@@ -833,8 +950,95 @@ static void decrease_dimension(struct mds* m)
 
 void mds_change_dimension(struct mds* m, int d)
 {
+  mds_thaw(m);
   while (m->d < d)
     increase_dimension(m);
   while (m->d > d)
     decrease_dimension(m);
 }
+
+/* the frozen arrays hold, for each entity of dimension less than the
+   mesh dimension, its one-level upward adjacencies in the same order
+   as the linked lists, with offsets by index as in CSR matrices */
+void mds_freeze(struct mds* m)
+{
+  int t;
+  mds_id i;
+  int j;
+  mds_id* o;
+  struct mds_set s;
+  mds_thaw(m);
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (mds_dim[t] >= m->d)
+      continue;
+    REALLOC(m->frozen_offset[t],m->end[t] + 1);
+    o = m->frozen_offset[t];
+    o[0] = 0;
+    for (i = 0; i < m->end[t]; ++i) {
+      s.n = 0;
+      if (m->free[t][i] == MDS_LIVE)
+        look_up(m,ID(t,i),mds_dim[t] + 1,&s);
+      o[i + 1] = o[i] + s.n;
+    }
+    REALLOC(m->frozen_up[t],o[m->end[t]]);
+    for (i = 0; i < m->end[t]; ++i)
+      if (m->free[t][i] == MDS_LIVE) {
+        look_up(m,ID(t,i),mds_dim[t] + 1,&s);
+        for (j = 0; j < s.n; ++j)
+          m->frozen_up[t][o[i] + j] = s.e[j];
+      }
+  }
+  m->frozen = 1;
+}
+
+void mds_thaw(struct mds* m)
+{
+  int t;
+  if (!m->frozen)
+    return;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    REALLOC(m->frozen_offset[t],0);
+    REALLOC(m->frozen_up[t],0);
+  }
+  m->frozen = 0;
+}
+
+/* returns the number of one-level upward adjacencies of (e) and
+   points (up) at them, or -1 if they are not frozen */
+int mds_get_frozen_up(struct mds* m, mds_id e, mds_id** up)
+{
+  int t;
+  mds_id* o;
+  t = TYPE(e);
+  if ((!m->frozen) || (mds_dim[t] >= m->d))
+    return -1;
+  o = m->frozen_offset[t] + INDEX(e);
+  *up = m->frozen_up[t] + o[0];
+  return o[1] - o[0];
+}
+
+/* creates all (n) entities of type (t) in an empty structure,
+   taking (down) as the array of their one-level downward adjacencies
+   laid out exactly as m->down. (down) must come from malloc. */
+void mds_adopt_entities(struct mds* m, int t, mds_id n, mds_id* down)
+{
+  int dd;
+  int deg;
+  mds_id i;
+  mds_id e;
+  PCU_ALWAYS_ASSERT(m->n[t] == 0);
+  PCU_ALWAYS_ASSERT(m->cap[t] == n);
+  mds_thaw(m);
+  deg = 0;
+  if (t != MDS_VERTEX) {
+    dd = mds_dim[t] - 1;
+    deg = mds_degree[t][dd];
+    REALLOC(m->down[dd][t],0);
+    m->down[dd][t] = down;
+  }
+  for (i = 0; i < n; ++i) {
+    e = alloc_ent(m,t);
+    if (t != MDS_VERTEX)
+      relate_back_up(m,down + i * deg,e);
+  }
+}
@@ -41,6 +41,9 @@ struct mds {
   mds_id* first_up[4][MDS_TYPES];
   mds_id* free[MDS_TYPES];
   mds_id first_free[MDS_TYPES];
+  int frozen;
+  mds_id* frozen_offset[MDS_TYPES];
+  mds_id* frozen_up[MDS_TYPES];
 };
 
 struct mds_set {
@@ -55,19 +58,31 @@ extern int const* mds_types[MDS_TYPES][4];
 void mds_create(struct mds* m, int d, mds_id cap[MDS_TYPES]);
 void mds_destroy(struct mds* m);
 mds_id mds_create_entity(struct mds* m, int type, mds_id *from);
+/* grows the capacity for type (t) to at least (n) entities,
+   the same as creating that many entities would, but at once */
+void mds_reserve(struct mds* m, int t, mds_id n);
 void mds_destroy_entity(struct mds* m, mds_id e);
 int mds_type(mds_id e);
 mds_id mds_index(mds_id e);
 mds_id mds_identify(int type, mds_id idx);
 void mds_get_adjacent(struct mds* m, mds_id e, int dim, struct mds_set* s);
+mds_id mds_find_entity(struct mds* m, int t, mds_id* from);
 mds_id mds_begin(struct mds* m, int dim);
 mds_id mds_next(struct mds* m, mds_id);
+mds_id mds_begin_range(struct mds* m, int dim, int i, int n, mds_id* stop);
+mds_id mds_next_range(struct mds* m, mds_id e, mds_id stop);
 
 void mds_add_adjacency(struct mds* m, int from_dim, int to_dim);
 void mds_remove_adjacency(struct mds* m, int from_dim, int to_dim);
 
 int mds_has_up(struct mds* m, mds_id e);
 
+void mds_freeze(struct mds* m);
+void mds_thaw(struct mds* m);
+int mds_get_frozen_up(struct mds* m, mds_id e, mds_id** up);
+
+void mds_adopt_entities(struct mds* m, int t, mds_id n, mds_id* down);
+
 void mds_change_dimension(struct mds* m, int d);
 
 void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down);
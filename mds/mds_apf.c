@@ -10,9 +10,15 @@
 
 #include "mds_apf.h"
 #include <stdlib.h>
+#include <string.h>
 #include <pcu_util.h>
 #include <PCU.h>
 
+static size_t ghost_bytes(mds_id cap)
+{
+  return (cap + 3) / 4;
+}
+
 struct mds_apf* mds_apf_create(struct gmi_model* model, int d,
     mds_id cap[MDS_TYPES])
 {
@@ -30,6 +36,8 @@ struct mds_apf* mds_apf_create(struct gmi_model* model, int d,
   m->user_model = model;
   for (t = 0; t < MDS_TYPES; ++t)
     m->parts[t] = calloc(cap[t], sizeof(*(m->parts[t])));
+  for (t = 0; t < MDS_TYPES; ++t)
+    m->ghost[t] = calloc(ghost_bytes(cap[t]), 1);
   mds_create_net(&m->remotes);
 //seol
   mds_create_net(&m->ghosts);
@@ -48,6 +56,8 @@ void mds_apf_destroy(struct mds_apf* m)
     free(m->model[t]);
   for (t = 0; t < MDS_TYPES; ++t)
     free(m->parts[t]);
+  for (t = 0; t < MDS_TYPES; ++t)
+    free(m->ghost[t]);
   free(m->point);
   free(m->param);
   mds_destroy_tags(&(m->tags));
@@ -75,35 +85,56 @@ void mds_apf_set_model(struct mds_apf* m, mds_id e, struct gmi_ent* model)
   m->model[mds_type(e)][mds_index(e)] = model;
 }
 
-mds_id mds_apf_create_entity(
-    struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from)
+/* grows everything kept per entity of (type) after the
+   mds structure grew from (old) to its current capacity */
+static void grow_apf(struct mds_apf* m, int type, mds_id old)
 {
   int t;
   mds_id old_cap[MDS_TYPES];
+  for (t = 0; t < MDS_TYPES; ++t)
+    old_cap[t] = m->mds.cap[t];
+  old_cap[type] = old;
+  mds_grow_tags(&(m->tags),&(m->mds),old_cap);
+  if (type == MDS_VERTEX) {
+    m->point = realloc(m->point,m->mds.cap[type] * sizeof(*(m->point)));
+    m->param = realloc(m->param,m->mds.cap[type] * sizeof(*(m->param)));
+  }
+  m->model[type] = realloc(m->model[type],
+      m->mds.cap[type] * sizeof(*(m->model[type])));
+  m->parts[type] = realloc(m->parts[type],
+      m->mds.cap[type] * sizeof(*(m->parts[type])));
+  m->ghost[type] = realloc(m->ghost[type],
+      ghost_bytes(m->mds.cap[type]));
+  memset(m->ghost[type] + ghost_bytes(old_cap[type]), 0,
+      ghost_bytes(m->mds.cap[type]) - ghost_bytes(old_cap[type]));
+  mds_grow_net(&m->remotes, &m->mds, old_cap); 
+  mds_grow_net(&m->ghosts, &m->mds, old_cap); //seol
+  mds_grow_net(&m->matches, &m->mds, old_cap);
+}
+
+void mds_apf_reserve(struct mds_apf* m, int type, mds_id n)
+{
+  mds_id old;
+  old = m->mds.cap[type];
+  mds_reserve(&(m->mds),type,n);
+  if (m->mds.cap[type] != old)
+    grow_apf(m,type,old);
+}
+
+mds_id mds_apf_create_entity(
+    struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from)
+{
+  mds_id old;
   mds_id e;
   mds_id i;
-  old_cap[type] = m->mds.cap[type];
+  old = m->mds.cap[type];
   e = mds_create_entity(&(m->mds),type,from);
   i = mds_index(e);
-  if (m->mds.cap[type] != old_cap[type]) {
-    for (t = 0; t < MDS_TYPES; ++t)
-      if (t != type)
-        old_cap[t] = m->mds.cap[t];
-    mds_grow_tags(&(m->tags),&(m->mds),old_cap);
-    if (type == MDS_VERTEX) {
-      m->point = realloc(m->point,m->mds.cap[type] * sizeof(*(m->point)));
-      m->param = realloc(m->param,m->mds.cap[type] * sizeof(*(m->param)));
-    }
-    m->model[type] = realloc(m->model[type],
-        m->mds.cap[type] * sizeof(*(m->model[type])));
-    m->parts[type] = realloc(m->parts[type],
-        m->mds.cap[type] * sizeof(*(m->parts[type])));
-    mds_grow_net(&m->remotes, &m->mds, old_cap); 
-    mds_grow_net(&m->ghosts, &m->mds, old_cap); //seol
-    mds_grow_net(&m->matches, &m->mds, old_cap);
-  }
+  if (m->mds.cap[type] != old)
+    grow_apf(m,type,old);
   m->model[type][i] = model;
   m->parts[type][i] = NULL;
+  mds_apf_set_ghost(m, e, 0);
   if (type == MDS_VERTEX) {
     m->point[i][0] = m->point[i][1] = m->point[i][2] = 0;
     m->param[i][0] = m->param[i][1] = 0;
@@ -123,6 +154,20 @@ void mds_apf_destroy_entity(struct mds_apf* m, mds_id e)
   mds_destroy_entity(&(m->mds),e);
 }
 
+int mds_apf_ghost(struct mds_apf* m, mds_id e)
+{
+  mds_id i = mds_index(e);
+  return (m->ghost[mds_type(e)][i / 4] >> ((i % 4) * 2)) & 3;
+}
+
+void mds_apf_set_ghost(struct mds_apf* m, mds_id e, int flags)
+{
+  mds_id i = mds_index(e);
+  unsigned char* b = &(m->ghost[mds_type(e)][i / 4]);
+  int shift = (i % 4) * 2;
+  *b = (unsigned char)((*b & ~(3 << shift)) | (flags << shift));
+}
+
 void* mds_get_part(struct mds_apf* m, mds_id e)
 {
   return m->parts[mds_type(e)][mds_index(e)];
@@ -38,6 +38,13 @@ struct mds_apf {
 //seol
   struct mds_net ghosts;
   struct mds_net matches;
+  unsigned char* ghost[MDS_TYPES]; /* MDS_GHOST* flags, four entities per byte */
+};
+
+/* flags returned by mds_apf_ghost */
+enum {
+  MDS_GHOST = 1, /* this is a ghost copy */
+  MDS_GHOSTED = 2 /* this has ghost copies elsewhere */
 };
 
 struct mds_apf* mds_apf_create(struct gmi_model* model, int d,
@@ -50,6 +57,10 @@ void mds_apf_set_model(struct mds_apf* m, mds_id e, struct gmi_ent* model);
 mds_id mds_apf_create_entity(
     struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from);
 void mds_apf_destroy_entity(struct mds_apf* m, mds_id e);
+void mds_apf_reserve(struct mds_apf* m, int type, mds_id n);
+
+int mds_apf_ghost(struct mds_apf* m, mds_id e);
+void mds_apf_set_ghost(struct mds_apf* m, mds_id e, int flags);
 
 void* mds_get_part(struct mds_apf* m, mds_id e);
 void mds_set_part(struct mds_apf* m, mds_id e, void* p);
@@ -66,6 +77,12 @@ struct mds_apf* mds_read_smb(struct gmi_model* model, const char* pathname,
     int ignore_peers, void* apf_mesh);
 struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
     int ignore_peers, void* apf_mesh);
+struct mds_apf* mds_write_smb_shared(struct mds_apf* m, const char* filename,
+    void* apf_mesh);
+int mds_smb_shared_parts(const char* filename);
+char* mds_read_smb_shared(const char* filename, int part, size_t* size);
+struct mds_apf* mds_read_smb_buffer(struct gmi_model* model, char* data,
+    size_t size, void* apf_mesh);
 
 void mds_verify(struct mds_apf* m);
 void mds_verify_residence(struct mds_apf* m, mds_id e);
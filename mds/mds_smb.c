@@ -22,7 +22,13 @@
 #include <sys/stat.h> /*using POSIX mkdir call for SMB "foo/" path*/
 #include <errno.h> /* for checking the error from mkdir */
 
-enum { SMB_VERSION = 5 };
+enum { SMB_VERSION = 6 };
+
+/* version 6 stores connectivity and coordinates as raw arrays in
+   the writer's native layout, each section starting at a multiple
+   of SMB_ALIGN bytes, so that a reader with the same layout can
+   read them straight into the structure's arrays. */
+enum { SMB_ALIGN = 64 };
 
 enum {
   SMB_VERT,
@@ -183,30 +189,152 @@ static void read_conn(struct pcu_file* f, struct mds_apf* m)
   }
 }
 
-static void write_conn(struct pcu_file* f, struct mds_apf* m)
+static size_t pad_bytes(size_t offset)
+{
+  return (SMB_ALIGN - (offset % SMB_ALIGN)) % SMB_ALIGN;
+}
+
+static void write_pad(struct pcu_file* f, size_t* offset)
+{
+  char zeros[SMB_ALIGN] = {0};
+  size_t n = pad_bytes(*offset);
+  pcu_write(f, zeros, n);
+  *offset += n;
+}
+
+static void write_raw(struct pcu_file* f, size_t* offset,
+    void* p, size_t bytes)
+{
+  write_pad(f, offset);
+  pcu_write(f, p, bytes);
+  *offset += bytes;
+}
+
+/* bytes in the raw sections header:
+   the leading version header, the counts, the byte order mark
+   and the identifier size */
+#define SMB_RAW_START ((4 + SMB_TYPES + 2) * sizeof(unsigned))
+
+static void write_raw_header(struct pcu_file* f)
+{
+  unsigned bom = 1;
+  unsigned id_bytes = sizeof(mds_id);
+  pcu_write(f, (char*)&bom, sizeof(bom));
+  PCU_WRITE_UNSIGNED(f, id_bytes);
+}
+
+static void write_raw_conn(struct pcu_file* f, struct mds_apf* m,
+    size_t* offset)
 {
-  unsigned* conn;
-  struct mds_set down;
-  mds_id end;
-  size_t size;
   int type_mds;
   int i;
-  mds_id j;
-  int k;
   for (i = 1; i < SMB_TYPES; ++i) {
     type_mds = smb2mds(i);
-    down.n = down_degree(type_mds);
-    end = m->mds.end[type_mds];
-    size = down.n * end;
-    conn = malloc(size * sizeof(*conn));
-    for (j = 0; j < end; ++j) {
-      mds_get_adjacent(&m->mds, mds_identify(type_mds, j),
-          mds_dim[type_mds] - 1, &down);
-      for (k = 0; k < down.n; ++k)
-        conn[j * down.n + k] = mds_index(down.e[k]);
-    }
-    pcu_write_unsigneds(f, conn, size);
-    free(conn);
+    write_raw(f, offset, m->mds.down[mds_dim[type_mds] - 1][type_mds],
+        m->mds.end[type_mds] * down_degree(type_mds) * sizeof(mds_id));
+  }
+}
+
+static void write_raw_coords(struct pcu_file* f, struct mds_apf* m,
+    size_t* offset)
+{
+  mds_id n = m->mds.end[MDS_VERTEX];
+  write_raw(f, offset, m->point, n * sizeof(*(m->point)));
+  write_raw(f, offset, m->param, n * sizeof(*(m->param)));
+}
+
+struct raw_source {
+  struct pcu_file* f;
+  size_t offset;
+  int swap;
+  unsigned id_bytes;
+};
+
+static void read_raw_header(struct pcu_file* f, struct raw_source* s)
+{
+  unsigned bom;
+  pcu_read(f, (char*)&bom, sizeof(bom));
+  s->swap = (bom != 1);
+  if (s->swap) {
+    pcu_swap_unsigneds(&bom, 1);
+    if (bom != 1)
+      reel_fail("MDS: bad byte order mark in smb file\n");
+  }
+  PCU_READ_UNSIGNED(f, s->id_bytes);
+  if (s->id_bytes != 4 && s->id_bytes != 8)
+    reel_fail("MDS: smb file has %u-byte identifiers\n", s->id_bytes);
+  s->offset = SMB_RAW_START;
+}
+
+/* returns a new malloc'd buffer holding the raw bytes of the next
+   section. the structure owns its arrays outright, so nothing refers
+   back to the file once it is loaded and the file may be rewritten. */
+static void* read_raw(struct raw_source* s, size_t bytes)
+{
+  size_t pad = pad_bytes(s->offset);
+  void* p;
+  pcu_skip(s->f, pad);
+  s->offset += pad;
+  if (!bytes)
+    return NULL;
+  p = malloc(bytes);
+  pcu_read(s->f, p, bytes);
+  s->offset += bytes;
+  return p;
+}
+
+static void swap_ids(void* p, size_t n, unsigned id_bytes)
+{
+  if (id_bytes == 4)
+    pcu_swap_unsigneds(p, n);
+  else
+    pcu_swap_doubles(p, n);
+}
+
+static mds_id* convert_ids(struct raw_source* s, void* p, size_t n)
+{
+  mds_id* ids;
+  size_t i;
+  if (s->swap)
+    swap_ids(p, n, s->id_bytes);
+  if (s->id_bytes == sizeof(mds_id))
+    return p;
+  ids = malloc(n * sizeof(mds_id));
+  for (i = 0; i < n; ++i) {
+    if (s->id_bytes == 4)
+      ids[i] = ((int*)p)[i];
+    else
+      ids[i] = ((long*)p)[i];
+  }
+  free(p);
+  return ids;
+}
+
+static void read_raw_conn(struct raw_source* s, struct mds_apf* m)
+{
+  int type_mds;
+  int i;
+  size_t n;
+  void* p;
+  mds_adopt_entities(&m->mds, MDS_VERTEX, m->mds.cap[MDS_VERTEX], NULL);
+  for (i = 1; i < SMB_TYPES; ++i) {
+    type_mds = smb2mds(i);
+    n = m->mds.cap[type_mds] * down_degree(type_mds);
+    p = convert_ids(s, read_raw(s, n * s->id_bytes), n);
+    mds_adopt_entities(&m->mds, type_mds, m->mds.cap[type_mds], p);
+  }
+}
+
+static void read_raw_coords(struct raw_source* s, struct mds_apf* m)
+{
+  mds_id n = m->mds.cap[MDS_VERTEX];
+  free(m->point);
+  free(m->param);
+  m->point = read_raw(s, n * sizeof(*(m->point)));
+  m->param = read_raw(s, n * sizeof(*(m->param)));
+  if (s->swap) {
+    pcu_swap_doubles(&m->point[0][0], n * 3);
+    pcu_swap_doubles(&m->param[0][0], n * 2);
   }
 }
 
@@ -557,11 +685,10 @@ static void write_matches(struct pcu_file* f, struct mds_apf* m,
     write_type_matches(f, m, smb2mds(t), ignore_peers);
 }
 
-static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+static struct mds_apf* read_smb_file(struct pcu_file* f,
+    struct gmi_model* model, int ignore_peers, void* apf_mesh)
 {
   struct mds_apf* m;
-  struct pcu_file* f;
   unsigned version;
   unsigned dim;
   unsigned n[SMB_TYPES];
@@ -569,8 +696,7 @@ static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
   int i;
   unsigned tmp;
   unsigned pi, pj;
-  f = pcu_fopen(filename, 0, zip);
-  PCU_ALWAYS_ASSERT(f);
+  struct raw_source raw;
   read_header(f, &version, &dim, ignore_peers);
   pcu_read_unsigneds(f, n, SMB_TYPES);
   for (i = 0; i < MDS_TYPES; ++i) {
@@ -579,15 +705,22 @@ static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
     cap[i] = tmp;
   }
   m = mds_apf_create(model, dim, cap);
-  make_verts(m);
-  read_conn(f, m);
-  pcu_read_doubles(f, &m->point[0][0], 3 * n[SMB_VERT]);
-  if (version >= 2) {
-    pcu_read_doubles(f, &m->param[0][0], 2 * n[SMB_VERT]);
+  if (version >= 6) {
+    raw.f = f;
+    read_raw_header(f, &raw);
+    read_raw_conn(&raw, m);
+    read_raw_coords(&raw, m);
   } else {
+    make_verts(m);
+    read_conn(f, m);
+    pcu_read_doubles(f, &m->point[0][0], 3 * n[SMB_VERT]);
+    if (version >= 2) {
+      pcu_read_doubles(f, &m->param[0][0], 2 * n[SMB_VERT]);
+    } else {
 /* initialize parameteric coordinates to zero if they are not in the file */
-    for (pi = 0; pi < n[SMB_VERT]; ++pi) {
-      for (pj = 0; pj < 2; ++pj) m->param[pi][pj] = 0.0;
+      for (pi = 0; pi < n[SMB_VERT]; ++pi) {
+        for (pj = 0; pj < 2; ++pj) m->param[pi][pj] = 0.0;
+      }
     }
   }
   read_remotes(f, m, ignore_peers);
@@ -599,38 +732,49 @@ static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
     read_matches_old(f, m, ignore_peers);
   if (version >= 5)
     mds_read_smb_meta(f, m, apf_mesh);
-  pcu_fclose(f);
   return m;
 }
 
-static void write_coords(struct pcu_file* f, struct mds_apf* m)
+static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
+    int zip, int ignore_peers, void* apf_mesh)
 {
-  size_t count;
-  count = m->mds.end[MDS_VERTEX] * 3;
-  pcu_write_doubles(f, &m->point[0][0], count);
-  count = m->mds.end[MDS_VERTEX] * 2;
-  pcu_write_doubles(f, &m->param[0][0], count);
+  struct mds_apf* m;
+  struct pcu_file* f;
+  f = pcu_fopen(filename, 0, zip);
+  PCU_ALWAYS_ASSERT(f);
+  m = read_smb_file(f, model, ignore_peers, apf_mesh);
+  pcu_fclose(f);
+  return m;
 }
 
-static void write_smb(struct mds_apf* m, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+static void write_smb_file(struct pcu_file* f, struct mds_apf* m,
+    int ignore_peers, void* apf_mesh)
 {
-  struct pcu_file* f;
   unsigned n[SMB_TYPES] = {0};
   int i;
-  f = pcu_fopen(filename, 1, zip);
-  PCU_ALWAYS_ASSERT(f);
+  size_t offset;
   write_header(f, m->mds.d, ignore_peers);
   for (i = 0; i < MDS_TYPES; ++i)
     n[mds2smb(i)] = m->mds.end[i];
   pcu_write_unsigneds(f, n, SMB_TYPES);
-  write_conn(f, m);
-  write_coords(f, m);
+  write_raw_header(f);
+  offset = SMB_RAW_START;
+  write_raw_conn(f, m, &offset);
+  write_raw_coords(f, m, &offset);
   write_remotes(f, m, ignore_peers);
   write_class(f, m);
   write_tags(f, m);
   write_matches(f, m, ignore_peers);
   mds_write_smb_meta(f, apf_mesh);
+}
+
+static void write_smb(struct mds_apf* m, const char* filename,
+    int zip, int ignore_peers, void* apf_mesh)
+{
+  struct pcu_file* f;
+  f = pcu_fopen(filename, 1, zip);
+  PCU_ALWAYS_ASSERT(f);
+  write_smb_file(f, m, ignore_peers, apf_mesh);
   pcu_fclose(f);
 }
 
@@ -750,12 +894,9 @@ static int is_compact(struct mds_apf* m)
   return 1;
 }
 
-struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
-    int ignore_peers, void* apf_mesh)
+static struct mds_apf* make_compact(struct mds_apf* m, int ignore_peers)
 {
   const char* reorderWarning ="MDS: reordering before writing smb files\n";
-  char* filename;
-  int zip;
   if (ignore_peers && (!is_compact(m))) {
     if(!PCU_Comm_Self()) lion_eprint(1, "%s", reorderWarning);
     m = mds_reorder(m, 1, mds_number_verts_bfs(m));
@@ -764,9 +905,192 @@ struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
     if(!PCU_Comm_Self()) lion_eprint(1, "%s", reorderWarning);
     m = mds_reorder(m, 0, mds_number_verts_bfs(m));
   }
+  return m;
+}
+
+struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
+    int ignore_peers, void* apf_mesh)
+{
+  char* filename;
+  int zip;
+  m = make_compact(m, ignore_peers);
   filename = handle_path(pathname, 1, &zip, ignore_peers);
   write_smb(m, filename, zip, ignore_peers, apf_mesh);
   free(filename);
   return m;
 }
 
+
+/* a shared smb file holds the parts of all ranks in one file:
+   an 8-byte magic string, the part count, then an (offset, size) pair
+   for each part, all as big-endian 64-bit integers.
+   each part is an ordinary smb stream starting at a multiple of
+   SMB_SHARED_ALIGN bytes so that no two ranks write the same
+   filesystem block. */
+enum { SMB_SHARED_ALIGN = 4096 };
+#define SMB_SHARED_MAGIC "PUMISMBS"
+#define SMB_SHARED_CHUNK (1 << 30)
+
+static size_t shared_align(size_t n)
+{
+  return ((n + SMB_SHARED_ALIGN - 1) / SMB_SHARED_ALIGN) * SMB_SHARED_ALIGN;
+}
+
+static void encode_u64(unsigned char* p, unsigned long x)
+{
+  int i;
+  for (i = 7; i >= 0; --i) {
+    p[i] = x & 0xFF;
+    x >>= 8;
+  }
+}
+
+static unsigned long decode_u64(unsigned char const* p)
+{
+  int i;
+  unsigned long x = 0;
+  for (i = 0; i < 8; ++i)
+    x = (x << 8) | p[i];
+  return x;
+}
+
+static void check_mpi(int err, const char* what, const char* filename)
+{
+  char msg[MPI_MAX_ERROR_STRING];
+  int len;
+  if (err == MPI_SUCCESS)
+    return;
+  MPI_Error_string(err, msg, &len);
+  reel_fail("MDS: %s \"%s\" failed: %s\n", what, filename, msg);
+}
+
+static MPI_File open_shared(const char* filename, int write)
+{
+  MPI_File fh;
+  int mode = write ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+  check_mpi(MPI_File_open(PCU_Get_Comm(), (char*)filename, mode,
+        MPI_INFO_NULL, &fh), "MPI_File_open", filename);
+  return fh;
+}
+
+/* collective read or write of one contiguous block per rank,
+   split into rounds so no single call exceeds an int count */
+static void shared_io(MPI_File fh, const char* filename, MPI_Offset at,
+    char* data, size_t size, int write)
+{
+  size_t done = 0;
+  size_t n;
+  int rounds;
+  int i;
+  MPI_Status st;
+  rounds = (size + SMB_SHARED_CHUNK - 1) / SMB_SHARED_CHUNK;
+  rounds = PCU_Max_Int(rounds);
+  for (i = 0; i < rounds; ++i) {
+    n = size - done;
+    if (n > SMB_SHARED_CHUNK)
+      n = SMB_SHARED_CHUNK;
+    if (write)
+      check_mpi(MPI_File_write_at_all(fh, at + done, data + done, (int)n,
+            MPI_BYTE, &st), "MPI_File_write_at_all", filename);
+    else
+      check_mpi(MPI_File_read_at_all(fh, at + done, data + done, (int)n,
+            MPI_BYTE, &st), "MPI_File_read_at_all", filename);
+    done += n;
+  }
+}
+
+struct mds_apf* mds_write_smb_shared(struct mds_apf* m, const char* filename,
+    void* apf_mesh)
+{
+  struct pcu_file* f;
+  char* data = NULL;
+  size_t size = 0;
+  size_t header;
+  unsigned long part[2];
+  unsigned long* parts = NULL;
+  unsigned char* encoded;
+  int np;
+  int i;
+  MPI_File fh;
+  MPI_Status st;
+  m = make_compact(m, 0);
+  f = pcu_memopen(&data, &size, 1);
+  write_smb_file(f, m, 0, apf_mesh);
+  pcu_fclose(f);
+  np = PCU_Comm_Peers();
+  header = shared_align(16 * ((size_t)np + 1));
+  part[0] = header + PCU_Exscan_Long(shared_align(size));
+  part[1] = size;
+  if (!PCU_Comm_Self())
+    parts = malloc(2 * np * sizeof(*parts));
+  MPI_Gather(part, 2, MPI_UNSIGNED_LONG, parts, 2, MPI_UNSIGNED_LONG,
+      0, PCU_Get_Comm());
+  fh = open_shared(filename, 1);
+  check_mpi(MPI_File_set_size(fh, 0), "MPI_File_set_size", filename);
+  if (!PCU_Comm_Self()) {
+    encoded = calloc(header, 1);
+    memcpy(encoded, SMB_SHARED_MAGIC, 8);
+    encode_u64(encoded + 8, np);
+    for (i = 0; i < 2 * np; ++i)
+      encode_u64(encoded + 16 + 8 * i, parts[i]);
+    check_mpi(MPI_File_write_at(fh, 0, encoded, (int)header, MPI_BYTE, &st),
+        "MPI_File_write_at", filename);
+    free(encoded);
+    free(parts);
+  }
+  shared_io(fh, filename, part[0], data, size, 1);
+  check_mpi(MPI_File_close(&fh), "MPI_File_close", filename);
+  free(data);
+  return m;
+}
+
+int mds_smb_shared_parts(const char* filename)
+{
+  unsigned char head[16];
+  unsigned long np = 0;
+  MPI_File fh;
+  MPI_Status st;
+  fh = open_shared(filename, 0);
+  if (!PCU_Comm_Self()) {
+    check_mpi(MPI_File_read_at(fh, 0, head, 16, MPI_BYTE, &st),
+        "MPI_File_read_at", filename);
+    if (memcmp(head, SMB_SHARED_MAGIC, 8))
+      reel_fail("MDS: \"%s\" is not a shared smb file\n", filename);
+    np = decode_u64(head + 8);
+  }
+  check_mpi(MPI_File_close(&fh), "MPI_File_close", filename);
+  MPI_Bcast(&np, 1, MPI_UNSIGNED_LONG, 0, PCU_Get_Comm());
+  return (int)np;
+}
+
+char* mds_read_smb_shared(const char* filename, int part, size_t* size)
+{
+  unsigned char entry[16];
+  MPI_Offset at = 0;
+  char* data = NULL;
+  MPI_File fh;
+  MPI_Status st;
+  *size = 0;
+  fh = open_shared(filename, 0);
+  if (part >= 0) {
+    check_mpi(MPI_File_read_at(fh, 16 + 16 * (MPI_Offset)part, entry, 16,
+          MPI_BYTE, &st), "MPI_File_read_at", filename);
+    at = decode_u64(entry);
+    *size = decode_u64(entry + 8);
+    data = malloc(*size);
+  }
+  shared_io(fh, filename, at, data, *size, 0);
+  check_mpi(MPI_File_close(&fh), "MPI_File_close", filename);
+  return data;
+}
+
+struct mds_apf* mds_read_smb_buffer(struct gmi_model* model, char* data,
+    size_t size, void* apf_mesh)
+{
+  struct pcu_file* f;
+  struct mds_apf* m;
+  f = pcu_memopen(&data, &size, 0);
+  m = read_smb_file(f, model, 0, apf_mesh);
+  pcu_fclose(f);
+  return m;
+}
@@ -27,9 +27,12 @@ namespace parma {
 
   void getImbalance(Weights* w, double& imb, double& avg) {
     double sum, max;
+    PCU_Request reqs[2];
     sum = max = w->self();
-    sum = PCU_Add_Double(sum);
-    max = PCU_Max_Double(max);
+    PCU_Iadd_Doubles(&sum, 1, &reqs[0]);
+    PCU_Imax_Doubles(&max, 1, &reqs[1]);
+    PCU_Wait(&reqs[0]);
+    PCU_Wait(&reqs[1]);
     avg = sum/PCU_Comm_Peers();
     imb = max/avg;
   }
@@ -93,9 +93,12 @@ namespace {
       double (*min)[4], double (*max)[4], double (*avg)[4]) {
     for(int d=0; d<=dim; d++)
       (*min)[d] = (*max)[d] = (*tot)[d] = (*loc)[d];
-    PCU_Min_Doubles(*min, dim+1);
-    PCU_Max_Doubles(*max, dim+1);
-    PCU_Add_Doubles(*tot, dim+1);
+    PCU_Request reqs[3];
+    PCU_Imin_Doubles(*min, dim+1, &reqs[0]);
+    PCU_Imax_Doubles(*max, dim+1, &reqs[1]);
+    PCU_Iadd_Doubles(*tot, dim+1, &reqs[2]);
+    for(int i=0; i<3; i++)
+      PCU_Wait(&reqs[i]);
     for(int d=0; d<=dim; d++) {
       (*avg)[d] = (*tot)[d];
       (*avg)[d] /= TO_DOUBLE(PCU_Comm_Peers());
@@ -168,8 +171,11 @@ void Parma_GetEntImbalance(apf::Mesh* mesh, double (*entImb)[4]) {
   dims = TO_SIZET(mesh->getDimension()) + 1;
   for(size_t i=0; i < dims; i++)
     tot[i] = (*entImb)[i] = mesh->count(TO_INT(i));
-  PCU_Add_Doubles(tot, dims);
-  PCU_Max_Doubles(*entImb, dims);
+  PCU_Request reqs[2];
+  PCU_Iadd_Doubles(tot, dims, &reqs[0]);
+  PCU_Imax_Doubles(*entImb, dims, &reqs[1]);
+  PCU_Wait(&reqs[0]);
+  PCU_Wait(&reqs[1]);
   for(size_t i=0; i < dims; i++)
     (*entImb)[i] /= (tot[i]/PCU_Comm_Peers());
   for(size_t i=dims; i < 4; i++)
@@ -183,8 +189,11 @@ void Parma_GetWeightedEntImbalance(apf::Mesh* mesh, apf::MeshTag* w,
   double tot[4] = {0,0,0,0};
   for(size_t i=0; i < dims; i++)
     tot[i] = (*entImb)[i];
-  PCU_Add_Doubles(tot, TO_SIZET(dims));
-  PCU_Max_Doubles(*entImb, TO_SIZET(dims));
+  PCU_Request reqs[2];
+  PCU_Iadd_Doubles(tot, TO_SIZET(dims), &reqs[0]);
+  PCU_Imax_Doubles(*entImb, TO_SIZET(dims), &reqs[1]);
+  PCU_Wait(&reqs[0]);
+  PCU_Wait(&reqs[1]);
   for(size_t i=0; i < dims; i++)
     (*entImb)[i] /= (tot[i]/PCU_Comm_Peers());
   for(size_t i=dims; i < 4; i++)
@@ -200,8 +209,13 @@ double Parma_GetWeightedEntImbalance(apf::Mesh* m, apf::MeshTag* w,
     while ((e = m->iterate(it)))
       sum += getEntWeight(m, e, w);
     m->end(it);
-   double tot = PCU_Add_Double(sum);
-   double max = PCU_Max_Double(sum);
+   double tot = sum;
+   double max = sum;
+   PCU_Request reqs[2];
+   PCU_Iadd_Doubles(&tot, 1, &reqs[0]);
+   PCU_Imax_Doubles(&max, 1, &reqs[1]);
+   PCU_Wait(&reqs[0]);
+   PCU_Wait(&reqs[1]);
    return max/(tot/PCU_Comm_Peers());
 }
 
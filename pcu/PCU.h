@@ -38,6 +38,8 @@ void PCU_Comm_Begin(void);
 int PCU_Comm_Pack(int to_rank, const void* data, size_t size);
 #define PCU_COMM_PACK(to_rank,object)\
 PCU_Comm_Pack(to_rank,&(object),sizeof(object))
+int PCU_Comm_Pack_Many(int to_rank, size_t n,
+    const void* const* data, const size_t* sizes);
 int PCU_Comm_Send(void);
 bool PCU_Comm_Receive(void);
 bool PCU_Comm_Listen(void);
@@ -51,6 +53,12 @@ PCU_Comm_Unpack(&(object),sizeof(object))
   above API on/off*/
 void PCU_Comm_Order(bool on);
 
+/*phase termination: NBX on/off, or
+  a symmetric set of known neighbors*/
+void PCU_Comm_Nbx(bool on);
+void PCU_Comm_Set_Neighbors(int const* peers, int n);
+void PCU_Comm_Unset_Neighbors(void);
+
 /*collective operations*/
 void PCU_Barrier(void);
 void PCU_Add_Doubles(double* p, size_t n);
@@ -80,6 +88,15 @@ int PCU_Max_Int(int x);
 int PCU_Or(int c);
 int PCU_And(int c);
 
+/*non-blocking collective operations*/
+typedef MPI_Request PCU_Request;
+void PCU_Iadd_Doubles(double* p, size_t n, PCU_Request* request);
+void PCU_Imin_Doubles(double* p, size_t n, PCU_Request* request);
+void PCU_Imax_Doubles(double* p, size_t n, PCU_Request* request);
+void PCU_Iadd_Longs(long* p, size_t n, PCU_Request* request);
+void PCU_Wait(PCU_Request* request);
+bool PCU_Test(PCU_Request* request);
+
 /*process-level self/peers (mpi wrappers)*/
 int PCU_Proc_Self(void);
 int PCU_Proc_Peers(void);
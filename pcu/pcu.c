@@ -40,6 +40,7 @@
 #include <sys/types.h> /*required for mode_t for mkdir on some systems*/
 #include <sys/stat.h> /*using POSIX mkdir call for SMB "foo/" path*/
 #include <errno.h> /* for checking the error from mkdir */
+#include <limits.h>
 
 enum state { uninit, init };
 static enum state global_state = uninit;
@@ -142,6 +143,30 @@ int PCU_Comm_Pack(int to_rank, const void* data, size_t size)
   return PCU_SUCCESS;
 }
 
+/** \brief Packs several blocks of data to be sent to \a to_rank.
+  \details This is equivalent to calling PCU_Comm_Pack(to_rank,data[i],sizes[i])
+  for each i in [0,n), but finds the destination buffer only once.
+ */
+int PCU_Comm_Pack_Many(int to_rank, size_t n,
+    const void* const* data, const size_t* sizes)
+{
+  size_t i;
+  size_t size = 0;
+  char* to;
+  if (global_state == uninit)
+    reel_fail("Comm_Pack_Many called before Comm_Init");
+  if ((to_rank < 0)||(to_rank >= pcu_mpi_size()))
+    reel_fail("Invalid rank in Comm_Pack_Many");
+  for (i = 0; i < n; ++i)
+    size += sizes[i];
+  to = pcu_msg_pack(get_msg(),to_rank,size);
+  for (i = 0; i < n; ++i) {
+    memcpy(to,data[i],sizes[i]);
+    to += sizes[i];
+  }
+  return PCU_SUCCESS;
+}
+
 /** \brief Sends all buffers for this communication phase.
   \details This function should be called by all threads in the MPI job
   after calls to PCU_Comm_Pack or PCU_Comm_Write and before calls
@@ -239,12 +264,90 @@ void PCU_Comm_Order(bool on)
   }
 }
 
+/** \brief Turns the NBX termination of communication phases on or off.
+  \details When on (the default), a phase ends with MPI_Ibarrier and
+  consecutive phases alternate message tags instead of starting
+  with a barrier. When off, the original PCU barrier is used.
+  This must be called by all ranks between communication phases.
+ */
+void PCU_Comm_Nbx(bool on)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Nbx called before Comm_Init");
+  pcu_msg_set_nbx(get_msg(), on);
+}
+
+/** \brief Declares the ranks this rank will exchange messages with.
+  \details While a neighbor set is declared, each communication phase
+  sends one small message to every neighbor and receives exactly one
+  from each, so no barrier or probing is needed to end the phase.
+  Messages may only be packed for ranks in \a peers or for the
+  calling rank itself.
+  The neighbor relation must be symmetric: if rank a lists rank b,
+  then rank b must list rank a.
+  This must be called by all ranks between communication phases,
+  and stays in effect until PCU_Comm_Unset_Neighbors or PCU_Switch_Comm.
+ */
+void PCU_Comm_Set_Neighbors(int const* peers, int n)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Set_Neighbors called before Comm_Init");
+  pcu_msg_set_neighbors(get_msg(), peers, n);
+}
+
+/** \brief Returns to communication phases with arbitrary peers.
+ */
+void PCU_Comm_Unset_Neighbors(void)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Unset_Neighbors called before Comm_Init");
+  pcu_msg_unset_neighbors(get_msg());
+}
+
+/* the collectives below go straight to the MPI library
+   on PCU's private collective communicator */
+
+static int coll_count(size_t n)
+{
+  if (n > INT_MAX)
+    reel_fail("PCU collective over %lu items exceeds INT_MAX",
+        (unsigned long)n);
+  return (int)n;
+}
+
+static MPI_Datatype size_t_type(void)
+{
+  if (sizeof(size_t) == sizeof(unsigned long))
+    return MPI_UNSIGNED_LONG;
+  return MPI_UNSIGNED_LONG_LONG;
+}
+
+static void allreduce(void* p, size_t n, MPI_Datatype type, MPI_Op op)
+{
+  MPI_Allreduce(MPI_IN_PLACE, p, coll_count(n), type, op, pcu_coll_comm);
+}
+
+static void iallreduce(void* p, size_t n, MPI_Datatype type, MPI_Op op,
+    PCU_Request* request)
+{
+  MPI_Iallreduce(MPI_IN_PLACE, p, coll_count(n), type, op, pcu_coll_comm,
+      request);
+}
+
+static void exscan(void* p, size_t n, MPI_Datatype type, size_t item)
+{
+  MPI_Exscan(MPI_IN_PLACE, p, coll_count(n), type, MPI_SUM, pcu_coll_comm);
+  /* MPI leaves the first rank's buffer undefined */
+  if (!pcu_mpi_rank())
+    memset(p, 0, n * item);
+}
+
 /** \brief Blocking barrier over all threads. */
 void PCU_Barrier(void)
 {
   if (global_state == uninit)
     reel_fail("Barrier called before Comm_Init");
-  pcu_barrier(&(get_msg()->coll));
+  MPI_Barrier(pcu_coll_comm);
 }
 
 /** \brief Performs an Allreduce sum of double arrays.
@@ -257,7 +360,7 @@ void PCU_Add_Doubles(double* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_Doubles called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_doubles,p,n*sizeof(double));
+  allreduce(p, n, MPI_DOUBLE, MPI_SUM);
 }
 
 double PCU_Add_Double(double x)
@@ -274,7 +377,7 @@ void PCU_Min_Doubles(double* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Min_Doubles called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_min_doubles,p,n*sizeof(double));
+  allreduce(p, n, MPI_DOUBLE, MPI_MIN);
 }
 
 double PCU_Min_Double(double x)
@@ -291,7 +394,7 @@ void PCU_Max_Doubles(double* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Max_Doubles called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_max_doubles,p,n*sizeof(double));
+  allreduce(p, n, MPI_DOUBLE, MPI_MAX);
 }
 
 double PCU_Max_Double(double x)
@@ -308,7 +411,7 @@ void PCU_Add_Ints(int* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_Ints called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_ints,p,n*sizeof(int));
+  allreduce(p, n, MPI_INT, MPI_SUM);
 }
 
 int PCU_Add_Int(int x)
@@ -325,7 +428,7 @@ void PCU_Add_Longs(long* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_Longs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_longs,p,n*sizeof(long));
+  allreduce(p, n, MPI_LONG, MPI_SUM);
 }
 
 long PCU_Add_Long(long x)
@@ -342,7 +445,7 @@ void PCU_Add_SizeTs(size_t* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Add_SizeTs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_add_sizets,p,n*sizeof(size_t));
+  allreduce(p, n, size_t_type(), MPI_SUM);
 }
 
 size_t PCU_Add_SizeT(size_t x)
@@ -358,7 +461,7 @@ size_t PCU_Add_SizeT(size_t x)
 void PCU_Min_SizeTs(size_t* p, size_t n) {
   if (global_state == uninit)
     reel_fail("Min_SizeTs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_min_sizets,p,n*sizeof(size_t));
+  allreduce(p, n, size_t_type(), MPI_MIN);
 }
 
 size_t PCU_Min_SizeT(size_t x) {
@@ -373,7 +476,7 @@ size_t PCU_Min_SizeT(size_t x) {
 void PCU_Max_SizeTs(size_t* p, size_t n) {
   if (global_state == uninit)
     reel_fail("Max_SizeTs called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_max_sizets,p,n*sizeof(size_t));
+  allreduce(p, n, size_t_type(), MPI_MAX);
 }
 
 size_t PCU_Max_SizeT(size_t x) {
@@ -393,15 +496,7 @@ void PCU_Exscan_Ints(int* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Exscan_Ints called before Comm_Init");
-  int* originals;
-  NOTO_MALLOC(originals,n);
-  for (size_t i=0; i < n; ++i)
-    originals[i] = p[i];
-  pcu_scan(&(get_msg()->coll),pcu_add_ints,p,n*sizeof(int));
-  //convert inclusive scan to exclusive
-  for (size_t i=0; i < n; ++i)
-    p[i] -= originals[i];
-  noto_free(originals);
+  exscan(p, n, MPI_INT, sizeof(int));
 }
 
 int PCU_Exscan_Int(int x)
@@ -417,15 +512,7 @@ void PCU_Exscan_Longs(long* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Exscan_Longs called before Comm_Init");
-  long* originals;
-  NOTO_MALLOC(originals,n);
-  for (size_t i=0; i < n; ++i)
-    originals[i] = p[i];
-  pcu_scan(&(get_msg()->coll),pcu_add_longs,p,n*sizeof(long));
-  //convert inclusive scan to exclusive
-  for (size_t i=0; i < n; ++i)
-    p[i] -= originals[i];
-  noto_free(originals);
+  exscan(p, n, MPI_LONG, sizeof(long));
 }
 
 long PCU_Exscan_Long(long x)
@@ -442,7 +529,7 @@ void PCU_Min_Ints(int* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Min_Ints called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_min_ints,p,n*sizeof(int));
+  allreduce(p, n, MPI_INT, MPI_MIN);
 }
 
 int PCU_Min_Int(int x)
@@ -459,7 +546,7 @@ void PCU_Max_Ints(int* p, size_t n)
 {
   if (global_state == uninit)
     reel_fail("Max_Ints called before Comm_Init");
-  pcu_allreduce(&(get_msg()->coll),pcu_max_ints,p,n*sizeof(int));
+  allreduce(p, n, MPI_INT, MPI_MAX);
 }
 
 int PCU_Max_Int(int x)
@@ -470,6 +557,62 @@ int PCU_Max_Int(int x)
   return a[0];
 }
 
+/** \brief Begins a non-blocking Allreduce sum of double arrays.
+  \details Like PCU_Add_Doubles, but returns immediately.
+  The contents of \a p are undefined until the operation is completed
+  by PCU_Wait or a successful PCU_Test on \a request.
+  All ranks must start their non-blocking and blocking collectives
+  in the same order.
+  */
+void PCU_Iadd_Doubles(double* p, size_t n, PCU_Request* request)
+{
+  if (global_state == uninit)
+    reel_fail("Iadd_Doubles called before Comm_Init");
+  iallreduce(p, n, MPI_DOUBLE, MPI_SUM, request);
+}
+
+/** \brief Begins a non-blocking Allreduce minimum of double arrays.
+  \details see PCU_Iadd_Doubles */
+void PCU_Imin_Doubles(double* p, size_t n, PCU_Request* request)
+{
+  if (global_state == uninit)
+    reel_fail("Imin_Doubles called before Comm_Init");
+  iallreduce(p, n, MPI_DOUBLE, MPI_MIN, request);
+}
+
+/** \brief Begins a non-blocking Allreduce maximum of double arrays.
+  \details see PCU_Iadd_Doubles */
+void PCU_Imax_Doubles(double* p, size_t n, PCU_Request* request)
+{
+  if (global_state == uninit)
+    reel_fail("Imax_Doubles called before Comm_Init");
+  iallreduce(p, n, MPI_DOUBLE, MPI_MAX, request);
+}
+
+/** \brief Begins a non-blocking Allreduce sum of long integers.
+  \details see PCU_Iadd_Doubles */
+void PCU_Iadd_Longs(long* p, size_t n, PCU_Request* request)
+{
+  if (global_state == uninit)
+    reel_fail("Iadd_Longs called before Comm_Init");
+  iallreduce(p, n, MPI_LONG, MPI_SUM, request);
+}
+
+/** \brief Completes a non-blocking collective. */
+void PCU_Wait(PCU_Request* request)
+{
+  MPI_Wait(request, MPI_STATUS_IGNORE);
+}
+
+/** \brief Returns true iff a non-blocking collective has completed.
+  \details once this returns true the request may not be tested again. */
+bool PCU_Test(PCU_Request* request)
+{
+  int flag;
+  MPI_Test(request, &flag, MPI_STATUS_IGNORE);
+  return flag;
+}
+
 /** \brief Performs a parallel logical OR reduction
   */
 int PCU_Or(int c)
@@ -725,6 +868,11 @@ void PCU_Switch_Comm(MPI_Comm new_comm)
 {
   if (global_state == uninit)
     reel_fail("Switch_Comm called before Comm_Init");
+  pcu_msg* m = get_msg();
+  /* ranks in the new communicator have not necessarily
+     gone through the same phases, so restart the tag parity */
+  pcu_msg_unset_neighbors(m);
+  m->phase = 0;
   pcu_pmpi_switch(new_comm);
 }
 
@@ -197,6 +197,30 @@ pcu_file* pcu_fopen(const char* name, bool write, bool compress)
   return pf;
 }
 
+/**
+ * brief open an in-memory file
+ * remark for writing, (*data) and (*size) describe a buffer grown by
+ *        the C library which stays valid after pcu_fclose and must
+ *        then be freed by the caller. for reading, they describe
+ *        an existing buffer that is not modified.
+ *        unlike pcu_fopen this is not collective.
+ */
+pcu_file* pcu_memopen(char** data, size_t* size, bool write)
+{
+  pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
+  pf->compress = false;
+  pf->write = write;
+  if (write)
+    pf->f = open_memstream(data, size);
+  else
+    pf->f = fmemopen(*data, *size, "r");
+  if (!pf->f) {
+    perror("pcu_memopen");
+    reel_fail("pcu_memopen couldn't open a buffer of %lu bytes", *size);
+  }
+  return pf;
+}
+
 void pcu_fclose(pcu_file* pf)
 {
   if (pf->compress)
@@ -239,6 +263,24 @@ void pcu_write(pcu_file* f, const char* p, size_t n)
   pcu_fwrite(p,1,n,f);
 }
 
+void pcu_skip(pcu_file* f, size_t n)
+{
+  char buf[4096];
+  size_t k;
+  if (f->write)
+    reel_fail("pcu_skip: file not opened for reading.");
+  if (!f->compress) {
+    if (fseek(f->f, (long)n, SEEK_CUR))
+      reel_fail("fseek(%p, %lu) failed", (void*) f->f, n);
+    return;
+  }
+  while (n) {
+    k = n < sizeof(buf) ? n : sizeof(buf);
+    compressed_read(f, buf, k);
+    n -= k;
+  }
+}
+
 static const uint16_t pcu_endian_value = 1;
 #define PCU_ENDIANNESS ((*((uint8_t*)(&pcu_endian_value)))==1)
 #define PCU_BIG_ENDIAN 0
@@ -22,9 +22,11 @@ extern "C" {
 struct pcu_file;
 
 struct pcu_file* pcu_fopen(const char* path, bool write, bool compress);
+struct pcu_file* pcu_memopen(char** data, size_t* size, bool write);
 void pcu_fclose (struct pcu_file * pf);
 void pcu_read(struct pcu_file* f, char* p, size_t n);
 void pcu_write(struct pcu_file* f, const char* p, size_t n);
+void pcu_skip(struct pcu_file* f, size_t n);
 void pcu_read_unsigneds(struct pcu_file* f, unsigned* p, size_t n);
 #define PCU_READ_UNSIGNED(f,p) pcu_read_unsigneds(f,&(p),1);
 void pcu_write_unsigneds(struct pcu_file* f, unsigned* p, size_t n);
@@ -12,6 +12,7 @@
 #include "noto_malloc.h"
 #include "reel.h"
 #include <string.h>
+#include <stdlib.h>
 
 /* the pcu_msg algorithm for a communication phase
    is as follows:
@@ -50,8 +51,42 @@
    If another rank is notified first and quickly goes on to
    a new phase, it may be able to send a message that is
    received by the slow rank out-of-phase.
+
+   By default the barrier at line 6 is MPI_Ibarrier, which makes
+   this the NBX algorithm of Hoefler, Siebert and Lumsdaine.
+   The barrier at line 1 is then replaced by alternating between
+   two message tags: no rank can finish a phase before all ranks
+   have begun its barrier, so a rank is at most one phase ahead
+   of any other, and messages of consecutive phases never match.
+
+   When a neighbor set is declared, each rank instead sends exactly
+   one size message (-1 if nothing was packed) to each neighbor,
+   followed by the data. Receivers post exact receives for these and
+   the phase ends once every neighbor has been heard from,
+   without any barrier or probing.
 */
 
+/* tags for the three kinds of phases. NBX and neighbor phases
+   alternate between (tag) and (tag + 1). */
+enum {
+  coll_tag = 0,
+  nbx_tag = 1,
+  nbrs_tag = 3
+};
+
+struct pcu_nbrs_struct
+{
+  int n; //number of neighbors
+  int* peers; //sorted neighbor ranks
+  long* out; //sizes sent to each neighbor
+  long* in; //sizes received from each neighbor
+  MPI_Request* recvs; //size receives, then data receives
+  MPI_Request* sends; //size sends, then data sends
+  pcu_buffer* bufs; //data received from each neighbor
+  int left; //neighbors not yet finished this phase
+};
+typedef struct pcu_nbrs_struct pcu_nbrs;
+
 //enumeration for pcu_msg.state
 enum {
   idle_state, //in between phases
@@ -72,6 +107,93 @@ void pcu_make_msg(pcu_msg* m)
   make_comm(m);
   m->file = NULL;
   m->order = NULL;
+  m->nbrs = NULL;
+  m->nbx = true;
+  m->phase = 0;
+  m->last = NULL;
+  m->table = NULL;
+  m->table_size = 0;
+  m->table_count = 0;
+}
+
+static int phase_tag(pcu_msg* m, int tag)
+{
+  return tag + (m->phase & 1);
+}
+
+static void start_nbrs(pcu_msg* m)
+{
+  pcu_nbrs* b = m->nbrs;
+  int tag = phase_tag(m, nbrs_tag);
+  int i;
+  for (i = 0; i < b->n; ++i) {
+    MPI_Irecv(&(b->in[i]), 1, MPI_LONG, b->peers[i], tag,
+        pcu_user_comm, &(b->recvs[i]));
+    b->recvs[b->n + i] = MPI_REQUEST_NULL;
+  }
+  b->left = b->n;
+}
+
+/* the tree orders the send buffers for sending and freeing,
+   lookups during packing go through the last-peer cache
+   and then a hash table with linear probing */
+static unsigned hash_rank(int id, int size)
+{
+  return (((unsigned)id) * 2654435761u) & ((unsigned)size - 1);
+}
+
+static pcu_msg_peer* find_peer(pcu_msg* m, int id)
+{
+  unsigned i;
+  pcu_msg_peer* peer;
+  if (m->last && m->last->message.peer == id)
+    return m->last;
+  if (!m->table_count)
+    return NULL;
+  for (i = hash_rank(id, m->table_size); (peer = m->table[i]);
+       i = (i + 1) & (m->table_size - 1))
+    if (peer->message.peer == id)
+      return m->last = peer;
+  return NULL;
+}
+
+static void hash_peer(pcu_msg* m, pcu_msg_peer* peer)
+{
+  unsigned i = hash_rank(peer->message.peer, m->table_size);
+  while (m->table[i])
+    i = (i + 1) & (m->table_size - 1);
+  m->table[i] = peer;
+}
+
+static void grow_table(pcu_msg* m)
+{
+  pcu_msg_peer** old = m->table;
+  int old_size = m->table_size;
+  int i;
+  m->table_size = old_size ? old_size * 2 : 16;
+  NOTO_MALLOC(m->table, m->table_size);
+  memset(m->table, 0, m->table_size * sizeof(pcu_msg_peer*));
+  for (i = 0; i < old_size; ++i)
+    if (old[i])
+      hash_peer(m, old[i]);
+  noto_free(old);
+}
+
+static void add_peer(pcu_msg* m, pcu_msg_peer* peer)
+{
+  if (2 * (m->table_count + 1) > m->table_size)
+    grow_table(m);
+  hash_peer(m, peer);
+  ++(m->table_count);
+  m->last = peer;
+}
+
+static void clear_table(pcu_msg* m)
+{
+  if (m->table_count)
+    memset(m->table, 0, m->table_size * sizeof(pcu_msg_peer*));
+  m->table_count = 0;
+  m->last = NULL;
 }
 
 static void free_peers(pcu_aa_tree* t)
@@ -91,10 +213,14 @@ void pcu_msg_start(pcu_msg* m)
 {
   if (m->state != idle_state)
     reel_fail("PCU_Comm_Begin called at the wrong time");
+  ++(m->phase);
+  if (m->nbrs)
+    start_nbrs(m);
+  else if (!m->nbx)
   /* this barrier ensures no one starts a new superstep
      while others are receiving in the past superstep.
      It is the only blocking call in the pcu_msg system. */
-  pcu_barrier(&(m->coll));
+    pcu_barrier(&(m->coll));
   m->state = pack_state;
 }
 
@@ -104,13 +230,6 @@ static bool peer_less(pcu_aa_node* a, pcu_aa_node* b)
        < ((pcu_msg_peer*)b)->message.peer;
 }
 
-static pcu_msg_peer* find_peer(pcu_aa_tree t, int id)
-{
-  pcu_msg_peer key;
-  key.message.peer = id;
-  return (pcu_msg_peer*) pcu_aa_find(&(key.node),t,peer_less);
-}
-
 static pcu_msg_peer* make_peer(int id)
 {
   pcu_msg_peer* p;
@@ -124,11 +243,12 @@ void* pcu_msg_pack(pcu_msg* m, int id, size_t size)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Pack called at the wrong time");
-  pcu_msg_peer* peer = find_peer(m->peers,id);
+  pcu_msg_peer* peer = find_peer(m,id);
   if (!peer)
   {
     peer = make_peer(id);
     pcu_aa_insert(&(peer->node),&(m->peers),peer_less);
+    add_peer(m,peer);
   }
   return pcu_push_buffer(&(peer->message.buffer),size);
 }
@@ -137,28 +257,69 @@ size_t pcu_msg_packed(pcu_msg* m, int id)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Packed called at the wrong time");
-  pcu_msg_peer* peer = find_peer(m->peers,id);
+  pcu_msg_peer* peer = find_peer(m,id);
   if (!peer)
     reel_fail("PCU_Comm_Packed called but nothing was packed");
   return peer->message.buffer.size;
 }
 
-static void send_peers(pcu_aa_tree t)
+static void send_peers(pcu_aa_tree t, int tag)
 {
   if (pcu_aa_empty(t))
     return;
   pcu_msg_peer* peer;
   peer = (pcu_msg_peer*)t;
-  pcu_mpi_send(&(peer->message),pcu_user_comm);
-  send_peers(t->left);
-  send_peers(t->right);
+  pcu_pmpi_send2(&(peer->message),tag,pcu_user_comm);
+  send_peers(t->left,tag);
+  send_peers(t->right,tag);
+}
+
+static int count_peers(pcu_aa_tree t)
+{
+  if (pcu_aa_empty(t))
+    return 0;
+  return 1 + count_peers(t->left) + count_peers(t->right);
+}
+
+static void send_nbrs(pcu_msg* m)
+{
+  pcu_nbrs* b = m->nbrs;
+  int tag = phase_tag(m, nbrs_tag);
+  int found = 0;
+  int count;
+  MPI_Datatype type;
+  int i;
+  for (i = 0; i < b->n; ++i) {
+    pcu_msg_peer* peer = find_peer(m, b->peers[i]);
+    b->out[i] = -1;
+    b->sends[b->n + i] = MPI_REQUEST_NULL;
+    if (peer) {
+      ++found;
+      b->out[i] = (long)(peer->message.buffer.size);
+    }
+    MPI_Isend(&(b->out[i]), 1, MPI_LONG, b->peers[i], tag,
+        pcu_user_comm, &(b->sends[i]));
+    if (peer) {
+      count = pcu_pmpi_bytes(peer->message.buffer.size, &type);
+      MPI_Isend(peer->message.buffer.start, count, type,
+          b->peers[i], tag, pcu_user_comm, &(b->sends[b->n + i]));
+      pcu_pmpi_free_bytes(&type);
+    }
+  }
+  if (found != count_peers(m->peers))
+    reel_fail("PCU_Comm_Pack to a rank outside the neighbor set");
 }
 
 void pcu_msg_send(pcu_msg* m)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Send called at the wrong time");
-  send_peers(m->peers);
+  if (m->nbrs)
+    send_nbrs(m);
+  else if (m->nbx)
+    send_peers(m->peers, phase_tag(m, nbx_tag));
+  else
+    send_peers(m->peers, coll_tag);
   m->state = send_recv_state;
 }
 
@@ -176,7 +337,7 @@ static bool done_sending_peers(pcu_aa_tree t)
 static bool receive_global(pcu_msg* m)
 {
   m->received.peer = MPI_ANY_SOURCE;
-  while ( ! pcu_mpi_receive(&(m->received),pcu_user_comm))
+  while ( ! pcu_pmpi_receive2(&(m->received),coll_tag,pcu_user_comm))
   {
     if (m->state == send_recv_state)
       if (done_sending_peers(m->peers))
@@ -191,8 +352,65 @@ static bool receive_global(pcu_msg* m)
   return true;
 }
 
+static bool receive_nbx(pcu_msg* m)
+{
+  int tag = phase_tag(m, nbx_tag);
+  int flag;
+  m->received.peer = MPI_ANY_SOURCE;
+  while ( ! pcu_pmpi_receive2(&(m->received),tag,pcu_user_comm))
+  {
+    if (m->state == send_recv_state)
+      if (done_sending_peers(m->peers))
+      {
+        MPI_Ibarrier(pcu_coll_comm, &(m->barrier));
+        m->state = recv_state;
+      }
+    if (m->state == recv_state) {
+      MPI_Test(&(m->barrier), &flag, MPI_STATUS_IGNORE);
+      if (flag)
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool receive_nbrs(pcu_msg* m)
+{
+  pcu_nbrs* b = m->nbrs;
+  int tag = phase_tag(m, nbrs_tag);
+  int count;
+  MPI_Datatype type;
+  int i;
+  pcu_buffer tmp;
+  while (b->left) {
+    MPI_Waitany(2 * b->n, b->recvs, &i, MPI_STATUS_IGNORE);
+    if (i < b->n) {
+      if (b->in[i] < 0) {
+        --(b->left);
+        continue;
+      }
+      pcu_resize_buffer(&(b->bufs[i]), (size_t)(b->in[i]));
+      count = pcu_pmpi_bytes(b->bufs[i].size, &type);
+      MPI_Irecv(b->bufs[i].start, count, type, b->peers[i],
+          tag, pcu_user_comm, &(b->recvs[b->n + i]));
+      pcu_pmpi_free_bytes(&type);
+    } else {
+      i -= b->n;
+      --(b->left);
+      tmp = m->received.buffer;
+      m->received.buffer = b->bufs[i];
+      b->bufs[i] = tmp;
+      m->received.peer = b->peers[i];
+      return true;
+    }
+  }
+  MPI_Waitall(2 * b->n, b->sends, MPI_STATUSES_IGNORE);
+  return false;
+}
+
 static void free_comm(pcu_msg* m)
 {
+  clear_table(m);
   free_peers(&(m->peers));
   pcu_free_message(&(m->received));
 }
@@ -204,7 +422,14 @@ bool pcu_msg_receive(pcu_msg* m)
     reel_fail("PCU_Comm_Receive called at the wrong time");
   if ( ! pcu_msg_unpacked(m))
     reel_fail("PCU_Comm_Receive called before previous message unpacked");
-  if (receive_global(m))
+  bool received;
+  if (m->nbrs)
+    received = receive_nbrs(m);
+  else if (m->nbx)
+    received = receive_nbx(m);
+  else
+    received = receive_global(m);
+  if (received)
   {
     pcu_begin_buffer(&(m->received.buffer));
     return true;
@@ -238,7 +463,68 @@ size_t pcu_msg_received_size(pcu_msg* m)
 void pcu_free_msg(pcu_msg* m)
 {
   free_comm(m);
+  noto_free(m->table);
+  pcu_msg_unset_neighbors(m);
   if (m->file)
     fclose(m->file);
 }
 
+void pcu_msg_set_nbx(pcu_msg* m, bool on)
+{
+  if (m->state != idle_state)
+    reel_fail("PCU_Comm_Nbx called at the wrong time");
+  m->nbx = on;
+}
+
+static int int_less(const void* a, const void* b)
+{
+  return *((int const*)a) - *((int const*)b);
+}
+
+void pcu_msg_set_neighbors(pcu_msg* m, int const* peers, int n)
+{
+  pcu_nbrs* b;
+  int i;
+  pcu_msg_unset_neighbors(m);
+  NOTO_MALLOC(b,1);
+  /* messages to self go through the same path */
+  NOTO_MALLOC(b->peers,n + 1);
+  for (i = 0; i < n; ++i)
+    b->peers[i] = peers[i];
+  b->peers[n] = pcu_mpi_rank();
+  qsort(b->peers, n + 1, sizeof(int), int_less);
+  b->n = 0;
+  for (i = 0; i <= n; ++i)
+    if (!b->n || b->peers[b->n - 1] != b->peers[i])
+      b->peers[(b->n)++] = b->peers[i];
+  NOTO_MALLOC(b->out,b->n);
+  NOTO_MALLOC(b->in,b->n);
+  NOTO_MALLOC(b->recvs,2 * b->n);
+  NOTO_MALLOC(b->sends,2 * b->n);
+  NOTO_MALLOC(b->bufs,b->n);
+  for (i = 0; i < b->n; ++i)
+    pcu_make_buffer(&(b->bufs[i]));
+  b->left = 0;
+  m->nbrs = b;
+}
+
+void pcu_msg_unset_neighbors(pcu_msg* m)
+{
+  pcu_nbrs* b = m->nbrs;
+  int i;
+  if (m->state != idle_state)
+    reel_fail("PCU neighbors changed at the wrong time");
+  if (!b)
+    return;
+  for (i = 0; i < b->n; ++i)
+    pcu_free_buffer(&(b->bufs[i]));
+  noto_free(b->bufs);
+  noto_free(b->sends);
+  noto_free(b->recvs);
+  noto_free(b->in);
+  noto_free(b->out);
+  noto_free(b->peers);
+  noto_free(b);
+  m->nbrs = NULL;
+}
+
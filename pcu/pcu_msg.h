@@ -15,9 +15,11 @@
 #include "pcu_io.h"
 
 /* the PCU Messenger (pcu_msg for short) system implements
-   a non-blocking Bulk Synchronous Parallel communication model
-   it is based on PCU non-blocking Collectives and pcu_mpi,
-   so it also works in hybrid mode */
+   a non-blocking Bulk Synchronous Parallel communication model.
+   termination of a phase is detected either with MPI_Ibarrier
+   (the NBX algorithm, the default), with PCU non-blocking
+   Collectives, or by exchanging one message with each member of
+   a known neighbor set. */
 
 /* a structure containing all data to be sent to a peer during
    this communication phase. */
@@ -28,12 +30,20 @@ typedef struct
 } pcu_msg_peer;
 
 struct pcu_order_struct;
+struct pcu_nbrs_struct;
 
 struct pcu_msg_struct
 {
   pcu_aa_tree peers; //binary tree of send buffers
+  pcu_msg_peer* last; //most recently packed send buffer
+  pcu_msg_peer** table; //open-addressed hash of send buffers by rank
+  int table_size; //zero or a power of two
+  int table_count; //number of send buffers in the table
   pcu_message received; //current received buffer
   pcu_coll coll; //collective operation object
+  MPI_Request barrier; //MPI_Ibarrier request for NBX termination
+  bool nbx; //detect termination with MPI_Ibarrier
+  int phase; //phase counter, its parity picks the message tag
   int state; //state within a communication phase
   /* below this point are variables that just need
      to be thread-specific but have been tacked onto
@@ -41,6 +51,7 @@ struct pcu_msg_struct
      pcu_thread struct to or something */
   FILE* file; //messenger-unique input or output file
   struct pcu_order_struct* order;
+  struct pcu_nbrs_struct* nbrs; //known neighbor set, if any
 };
 typedef struct pcu_msg_struct pcu_msg;
 
@@ -59,5 +70,8 @@ bool pcu_msg_unpacked(pcu_msg* m);
 int pcu_msg_received_from(pcu_msg* m);
 size_t pcu_msg_received_size(pcu_msg* m);
 void pcu_free_msg(pcu_msg* m);
+void pcu_msg_set_nbx(pcu_msg* m, bool on);
+void pcu_msg_set_neighbors(pcu_msg* m, int const* peers, int n);
+void pcu_msg_unset_neighbors(pcu_msg* m);
 
 #endif //PCU_MSG_H
@@ -52,6 +52,47 @@ int pcu_pmpi_rank(void)
   return global_rank;
 }
 
+/* messages longer than INT_MAX bytes are described by one
+   element of a derived datatype made of 1GB blocks followed
+   by the remainder. its type signature is still a sequence of
+   MPI_BYTE, so it matches a receive of the same size
+   however that receive was described. */
+static size_t const chunk_size = ((size_t)1) << 30;
+
+int pcu_pmpi_bytes(size_t n, MPI_Datatype* type)
+{
+  MPI_Datatype chunk;
+  MPI_Datatype chunks;
+  MPI_Datatype types[2];
+  int lengths[2];
+  MPI_Aint displs[2];
+  if (n <= (size_t)INT_MAX) {
+    *type = MPI_BYTE;
+    return (int)n;
+  }
+  MPI_Type_contiguous((int)chunk_size, MPI_BYTE, &chunk);
+  MPI_Type_contiguous((int)(n / chunk_size), chunk, &chunks);
+  types[0] = chunks;
+  types[1] = MPI_BYTE;
+  lengths[0] = 1;
+  lengths[1] = (int)(n % chunk_size);
+  displs[0] = 0;
+  displs[1] = (MPI_Aint)(n - n % chunk_size);
+  MPI_Type_create_struct(2, lengths, displs, types, type);
+  MPI_Type_commit(type);
+  MPI_Type_free(&chunks);
+  MPI_Type_free(&chunk);
+  return 1;
+}
+
+/* MPI keeps a freed datatype alive until pending
+   operations using it have completed */
+void pcu_pmpi_free_bytes(MPI_Datatype* type)
+{
+  if (*type != MPI_BYTE)
+    MPI_Type_free(type);
+}
+
 void pcu_pmpi_send(pcu_message* m, MPI_Comm comm)
 {
   pcu_pmpi_send2(m,0,comm);
@@ -59,18 +100,17 @@ void pcu_pmpi_send(pcu_message* m, MPI_Comm comm)
 
 void pcu_pmpi_send2(pcu_message* m, int tag, MPI_Comm comm)
 {
-  if( m->buffer.size > (size_t)INT_MAX ) {
-    fprintf(stderr, "ERROR PCU message size exceeds INT_MAX... exiting\n");
-    abort();
-  }
+  MPI_Datatype type;
+  int count = pcu_pmpi_bytes(m->buffer.size, &type);
   MPI_Issend(
       m->buffer.start,
-      (int)(m->buffer.size),
-      MPI_BYTE,
+      count,
+      type,
       m->peer,
       tag,
       comm,
       &(m->request));
+  pcu_pmpi_free_bytes(&type);
 }
 
 bool pcu_pmpi_done(pcu_message* m)
@@ -93,17 +133,20 @@ bool pcu_pmpi_receive2(pcu_message* m, int tag, MPI_Comm comm)
   if (!flag)
     return false;
   m->peer = status.MPI_SOURCE;
-  int count;
-  MPI_Get_count(&status,MPI_BYTE,&count);
-  pcu_resize_buffer(&(m->buffer),(size_t)count);
+  MPI_Count size;
+  MPI_Get_elements_x(&status,MPI_BYTE,&size);
+  pcu_resize_buffer(&(m->buffer),(size_t)size);
+  MPI_Datatype type;
+  int count = pcu_pmpi_bytes(m->buffer.size, &type);
   MPI_Recv(
       m->buffer.start,
-      (int)(m->buffer.size),
-      MPI_BYTE,
+      count,
+      type,
       m->peer,
       tag,
       comm,
       MPI_STATUS_IGNORE);
+  pcu_pmpi_free_bytes(&type);
   return true;
 }
 
@@ -23,6 +23,8 @@ bool pcu_pmpi_receive(pcu_message* m, MPI_Comm comm);
 void pcu_pmpi_send2(pcu_message* m, int tag, MPI_Comm comm);
 bool pcu_pmpi_receive2(pcu_message* m, int tag, MPI_Comm comm);
 bool pcu_pmpi_done(pcu_message* m);
+int pcu_pmpi_bytes(size_t n, MPI_Datatype* type);
+void pcu_pmpi_free_bytes(MPI_Datatype* type);
 
 void pcu_pmpi_switch(MPI_Comm new_comm);
 MPI_Comm pcu_pmpi_comm(void);
@@ -0,0 +1,231 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <ma.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* refines a box split into slabs uniformly with the profile of
+   ma::adapt going to a CSV and then a JSON file, and checks on rank
+   zero that both parse and that the refine stage counted one split
+   per edge */
+
+namespace {
+
+std::string readFile(const char* name)
+{
+  std::ifstream f(name);
+  PCU_ALWAYS_ASSERT(f.good());
+  std::stringstream s;
+  s << f.rdbuf();
+  return s.str();
+}
+
+/* a recursive descent check of JSON syntax, which advances (p)
+   past one value and returns false if there is none */
+class JsonChecker
+{
+  public:
+    JsonChecker(const char* s):p(s) {}
+    bool checkDocument()
+    {
+      if (!checkValue())
+        return false;
+      skipSpace();
+      return !*p;
+    }
+  private:
+    void skipSpace()
+    {
+      while (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')
+        ++p;
+    }
+    bool accept(char c)
+    {
+      skipSpace();
+      if (*p != c)
+        return false;
+      ++p;
+      return true;
+    }
+    bool checkString()
+    {
+      if (!accept('"'))
+        return false;
+      for (; *p && *p != '"'; ++p)
+        if (*p == '\\' && !*++p)
+          return false;
+      return *p++ == '"';
+    }
+    bool checkNumber()
+    {
+      if (*p != '-' && !isdigit(*p))
+        return false;
+      char* end;
+      strtod(p, &end);
+      if (end == p)
+        return false;
+      p = end;
+      return true;
+    }
+    template <class F>
+    bool checkList(char close, F item)
+    {
+      if (accept(close))
+        return true;
+      do {
+        if (!(this->*item)())
+          return false;
+      } while (accept(','));
+      return accept(close);
+    }
+    bool checkMember()
+    {
+      return checkString() && accept(':') && checkValue();
+    }
+    bool checkValue()
+    {
+      skipSpace();
+      if (accept('{'))
+        return checkList('}', &JsonChecker::checkMember);
+      if (accept('['))
+        return checkList(']', &JsonChecker::checkValue);
+      if (*p == '"')
+        return checkString();
+      return checkNumber();
+    }
+    const char* p;
+};
+
+std::vector<std::string> split(std::string const& line)
+{
+  std::vector<std::string> fields;
+  std::stringstream s(line);
+  std::string field;
+  while (std::getline(s, field, ','))
+    fields.push_back(field);
+  return fields;
+}
+
+bool close(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-6 * std::fabs(b);
+}
+
+void checkRefineCounts(double attempts, double successes, long edges)
+{
+  PCU_ALWAYS_ASSERT(attempts == successes);
+  PCU_ALWAYS_ASSERT(close(successes * PCU_Comm_Peers(), edges));
+}
+
+/* every row has the fields of the header, all numbers after the
+   stage name, and the refine stage of the first iteration split
+   every edge */
+void checkCsv(const char* name, long edges)
+{
+  std::stringstream s(readFile(name));
+  std::string line;
+  std::getline(s, line);
+  std::vector<std::string> header = split(line);
+  PCU_ALWAYS_ASSERT(header.size() == 3 + 9 * 3);
+  PCU_ALWAYS_ASSERT(header[0] == "stage");
+  int attempts = -1;
+  int successes = -1;
+  for (size_t i = 0; i < header.size(); ++i) {
+    if (header[i] == "attempts_avg")
+      attempts = i;
+    if (header[i] == "successes_avg")
+      successes = i;
+  }
+  PCU_ALWAYS_ASSERT(attempts > 0 && successes > 0);
+  bool foundRefine = false;
+  while (std::getline(s, line)) {
+    std::vector<std::string> row = split(line);
+    PCU_ALWAYS_ASSERT(row.size() == header.size());
+    for (size_t i = 1; i < row.size(); ++i) {
+      char* end;
+      strtod(row[i].c_str(), &end);
+      PCU_ALWAYS_ASSERT(!*end);
+    }
+    if (row[0] == "refine" && row[1] == "0") {
+      foundRefine = true;
+      checkRefineCounts(atof(row[attempts].c_str()),
+          atof(row[successes].c_str()), edges);
+    }
+  }
+  PCU_ALWAYS_ASSERT(foundRefine);
+}
+
+double getAverage(const char* stage, const char* value)
+{
+  std::string key = std::string("\"") + value + "\": {";
+  const char* p = strstr(stage, key.c_str());
+  PCU_ALWAYS_ASSERT(p);
+  double min, max, avg;
+  PCU_ALWAYS_ASSERT(sscanf(p + key.size(),
+        "\"min\": %lf, \"max\": %lf, \"avg\": %lf", &min, &max, &avg) == 3);
+  PCU_ALWAYS_ASSERT(min <= avg && avg <= max);
+  return avg;
+}
+
+void checkJson(const char* name, long edges)
+{
+  std::string text = readFile(name);
+  PCU_ALWAYS_ASSERT(JsonChecker(text.c_str()).checkDocument());
+  const char* stage = strstr(text.c_str(),
+      "{\"name\": \"refine\", \"iteration\": 0,");
+  PCU_ALWAYS_ASSERT(stage);
+  checkRefineCounts(getAverage(stage, "attempts"),
+      getAverage(stage, "successes"), edges);
+}
+
+long refine(ma::Mesh* m, const char* profileFile)
+{
+  long edges = PCU_Add_Long(m->count(1));
+  ma::Input* in = ma::configureUniformRefine(m, 1);
+  in->shouldCoarsen = false;
+  in->profileFile = profileFile;
+  ma::adapt(in);
+  return edges;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n>\n"
+             "  refines an n x n x n box split into slabs\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  gmi_register_null();
+  ma::Mesh* m = makeSlabs(n);
+  long csvEdges = refine(m, "adaptProfile.csv");
+  long jsonEdges = refine(m, "adaptProfile.json");
+  if (!PCU_Comm_Self()) {
+    checkCsv("adaptProfile.csv", csvEdges);
+    checkJson("adaptProfile.json", jsonEdges);
+  }
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
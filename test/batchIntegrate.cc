@@ -0,0 +1,172 @@
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfElementBatch.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+/* integrates the volume of a box and a linear field over it with
+   apf::Integrator and with apf::BatchIntegrator, checks that they
+   agree, and reports the elements integrated per second by each */
+
+namespace {
+
+class Integrator : public apf::Integrator
+{
+  public:
+    Integrator(apf::Field* f, int o):
+      apf::Integrator(o),
+      field(f),
+      element(0),
+      volume(0),
+      integral(0)
+    {
+    }
+    void inElement(apf::MeshElement* me)
+    {
+      element = apf::createElement(field, me);
+    }
+    void outElement()
+    {
+      apf::destroyElement(element);
+    }
+    void atPoint(apf::Vector3 const& p, double w, double dV)
+    {
+      volume += w * dV;
+      integral += apf::getScalar(element, p) * w * dV;
+    }
+    void parallelReduce()
+    {
+      volume = PCU_Add_Double(volume);
+      integral = PCU_Add_Double(integral);
+    }
+    apf::Field* field;
+    apf::Element* element;
+    double volume;
+    double integral;
+};
+
+class BatchIntegrator : public apf::BatchIntegrator
+{
+  public:
+    BatchIntegrator(apf::Field* f, int o):
+      apf::BatchIntegrator(o),
+      field(f),
+      volume(0),
+      integral(0)
+    {
+    }
+    void inBatch(apf::ElementBatch& b)
+    {
+      int n = b.countElements();
+      int np = b.countPoints();
+      values.resize(np * n);
+      b.interpolate(field, &values[0]);
+      for (int p = 0; p < np; ++p) {
+        double w = b.getWeight(p);
+        double const* dv = b.getDVs(p);
+        double const* u = &values[p * n];
+        for (int i = 0; i < n; ++i) {
+          volume += w * dv[i];
+          integral += u[i] * w * dv[i];
+        }
+      }
+    }
+    void parallelReduce()
+    {
+      volume = PCU_Add_Double(volume);
+      integral = PCU_Add_Double(integral);
+    }
+    apf::Field* field;
+    std::vector<double> values;
+    double volume;
+    double integral;
+};
+
+apf::Field* makeLinearField(apf::Mesh* m)
+{
+  apf::Field* f = apf::createFieldOn(m, "linear", apf::SCALAR);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    apf::setScalar(f, v, 0, x[0] + 2 * x[1] + 3 * x[2]);
+  }
+  m->end(it);
+  return f;
+}
+
+bool close(double a, double b)
+{
+  return std::fabs(a - b) < 1e-10 * std::max(1.0, std::fabs(b));
+}
+
+void report(const char* what, double t, long elements)
+{
+  t = PCU_Max_Double(t);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "  %s: %f seconds, %.3e elements per second\n",
+        what, t, elements / t);
+}
+
+void run(apf::Mesh* m, apf::Field* f, int order, int repeat)
+{
+  int dim = m->getDimension();
+  long elements = PCU_Add_Long(apf::countOwned(m, dim)) * repeat;
+  Integrator a(f, order);
+  BatchIntegrator b(f, order);
+  double t0 = PCU_Time();
+  for (int r = 0; r < repeat; ++r)
+    a.process(m);
+  double t1 = PCU_Time();
+  for (int r = 0; r < repeat; ++r)
+    b.process(m);
+  double t2 = PCU_Time();
+  PCU_ALWAYS_ASSERT(close(a.volume, b.volume));
+  PCU_ALWAYS_ASSERT(close(a.integral, b.integral));
+  PCU_ALWAYS_ASSERT(close(b.volume / repeat, 1));
+  PCU_ALWAYS_ASSERT(close(b.integral / repeat, 3));
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s coordinates, order %d\n",
+        m->getShape()->getName(), order);
+  report("apf::Integrator", t1 - t0, elements);
+  report("apf::BatchIntegrator", t2 - t1, elements);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 3) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <repeat>\n"
+             "  integrates over an n x n x n box\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int repeat = atoi(argv[2]);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+  apf::Field* f = makeLinearField(m);
+  run(m, f, 1, repeat);
+  run(m, f, 2, repeat);
+  apf::changeMeshShape(m, apf::getLagrange(2), true);
+  run(m, f, 2, repeat);
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,101 @@
+#include <ma.h>
+#include <maAdapt.h>
+#include <maCoarsen.h>
+#include <maShape.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfThreads.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+
+/* coarsens a box to a size that grows along x, once with the usual
+   edge collapses and once with their quality evaluated on threads,
+   and reports the collapses per second of each */
+
+namespace {
+
+class Growing : public ma::IsotropicFunction
+{
+  public:
+    Growing(ma::Mesh* m, double s):
+      mesh(m),
+      scale(s)
+    {
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      return scale * (0.5 + p[0]);
+    }
+  private:
+    ma::Mesh* mesh;
+    double scale;
+};
+
+double getWorstQuality(ma::Adapt* a)
+{
+  ma::Mesh* m = a->mesh;
+  double worst = 1;
+  ma::Iterator* it = m->begin(3);
+  ma::Entity* e;
+  while ((e = m->iterate(it)))
+    worst = std::min(worst, ma::measureTetQuality(m, a->sizeField, e));
+  m->end(it);
+  return worst;
+}
+
+long coarsenBox(const char* what, int n, bool withThreads)
+{
+  ma::Mesh* m = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+  Growing f(m, 4.0 / n);
+  ma::Input* in = ma::configure(m, &f);
+  in->shouldSnap = false;
+  in->shouldTransferParametric = false;
+  in->shouldCollapseWithThreads = withThreads;
+  ma::Adapt* a = new ma::Adapt(in);
+  long before = m->count(0);
+  double t0 = PCU_Time();
+  ma::coarsen(a);
+  double t = PCU_Time() - t0;
+  long collapses = before - long(m->count(0));
+  lion_oprint(1, "%s: %ld collapses in %f seconds, %e collapses/second\n",
+      what, collapses, t, collapses / t);
+  PCU_ALWAYS_ASSERT(collapses > 0);
+  PCU_ALWAYS_ASSERT(getWorstQuality(a) >= in->validQuality);
+  delete a;
+  delete in;
+  m->verify();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  return collapses;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 3 || PCU_Comm_Peers() != 1) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <threads>\n"
+             "  coarsens an n x n x n box on one rank\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int threads = atoi(argv[2]);
+  gmi_register_null();
+  long serial = coarsenBox("serial", n, false);
+  apf::setThreadCount(threads);
+  long threaded = coarsenBox("threaded", n, true);
+  /* the threaded pass makes the same decisions, in another order */
+  PCU_ALWAYS_ASSERT(threaded * 10 > serial * 9);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,81 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cstring>
+
+/* in "write" mode, splits a box into slabs and writes it with
+   apf::writeMdsMeshCollective. in "load" mode, reads that file with
+   apf::loadMdsMeshCollective, possibly on more ranks than wrote it,
+   verifies the result and checks its global entity counts against
+   the same box built on one rank */
+
+namespace {
+
+void getGlobalCounts(apf::Mesh* m, long counts[4])
+{
+  for (int d = 0; d <= 3; ++d)
+    counts[d] = apf::countOwned(m, d);
+  PCU_Add_Longs(counts, 4);
+}
+
+void getBoxCounts(int n, long counts[4])
+{
+  int self = PCU_Comm_Self();
+  for (int d = 0; d <= 3; ++d)
+    counts[d] = 0;
+  PCU_Switch_Comm(MPI_COMM_SELF);
+  if (!self) {
+    apf::Mesh2* box = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+    for (int d = 0; d <= 3; ++d)
+      counts[d] = box->count(d);
+    box->destroyNative();
+    apf::destroyMesh(box);
+  }
+  PCU_Switch_Comm(MPI_COMM_WORLD);
+  PCU_Add_Longs(counts, 4);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 4 || (strcmp(argv[3], "write") && strcmp(argv[3], "load"))) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <file> write|load\n"
+             "  writes an n x n x n box split into slabs to one file,\n"
+             "  or loads and checks such a file\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  const char* fileName = argv[2];
+  gmi_register_null();
+  apf::Mesh2* m;
+  if (!strcmp(argv[3], "write")) {
+    m = makeSlabs(n);
+    apf::writeMdsMeshCollective(m, fileName);
+  } else {
+    m = apf::loadMdsMeshCollective(gmi_load(".null"), fileName);
+    m->verify();
+    long counts[4];
+    long expected[4];
+    getGlobalCounts(m, counts);
+    getBoxCounts(n, expected);
+    for (int d = 0; d <= 3; ++d)
+      PCU_ALWAYS_ASSERT(counts[d] == expected[d]);
+  }
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,134 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfExchange.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cmath>
+
+/* compares apf::synchronize and apf::accumulate with the same
+   operations done through an apf::Exchange plan, on a box split
+   into slabs, and reports the time taken by each */
+
+namespace {
+
+/* a value every copy of an entity agrees on, kept integral
+   so that sums do not depend on the order they are taken in */
+void setValues(apf::Mesh* m, apf::Field* f, bool ownedOnly)
+{
+  int nc = apf::countComponents(f);
+  apf::NewArray<double> c(nc);
+  for (int d = 0; d <= 3; ++d) {
+    if (!apf::getShape(f)->hasNodesIn(d))
+      continue;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      for (int i = 0; i < nc; ++i)
+        c[i] = floor(x[i % 3] * 1000) + i;
+      if (ownedOnly && !m->isOwned(e))
+        for (int i = 0; i < nc; ++i)
+          c[i] = -1;
+      int nn = apf::getShape(f)->countNodesOn(m->getType(e));
+      for (int j = 0; j < nn; ++j)
+        apf::setComponents(f, e, j, &c[0]);
+    }
+    m->end(it);
+  }
+}
+
+void compare(apf::Mesh* m, apf::Field* a, apf::Field* b)
+{
+  int nc = apf::countComponents(a);
+  apf::NewArray<double> ca(nc);
+  apf::NewArray<double> cb(nc);
+  for (int d = 0; d <= 3; ++d) {
+    if (!apf::getShape(a)->hasNodesIn(d))
+      continue;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      int nn = apf::getShape(a)->countNodesOn(m->getType(e));
+      for (int j = 0; j < nn; ++j) {
+        apf::getComponents(a, e, j, &ca[0]);
+        apf::getComponents(b, e, j, &cb[0]);
+        for (int i = 0; i < nc; ++i)
+          PCU_ALWAYS_ASSERT(ca[i] == cb[i]);
+      }
+    }
+    m->end(it);
+  }
+}
+
+void report(const char* what, double t, int repeat)
+{
+  t = PCU_Max_Double(t);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s: %f seconds per call\n", what, t / repeat);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 3) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <repeat>\n"
+             "  splits an n x n x n box into slabs\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int repeat = atoi(argv[2]);
+  gmi_register_null();
+  apf::Mesh2* m = makeSlabs(n);
+  apf::Field* fields[4];
+  fields[0] = apf::createFieldOn(m, "u", apf::VECTOR);
+  fields[1] = apf::createField(m, "p", apf::SCALAR, apf::getLagrange(2));
+  fields[2] = apf::createFieldOn(m, "u_ref", apf::VECTOR);
+  fields[3] = apf::createField(m, "p_ref", apf::SCALAR, apf::getLagrange(2));
+  double t0 = PCU_Time();
+  apf::Exchange plan(m);
+  report("plan", PCU_Time() - t0, 1);
+  /* synchronize */
+  for (int i = 0; i < 4; ++i)
+    setValues(m, fields[i], true);
+  t0 = PCU_Time();
+  for (int r = 0; r < repeat; ++r) {
+    apf::synchronize(fields[2]);
+    apf::synchronize(fields[3]);
+  }
+  report("apf::synchronize", PCU_Time() - t0, repeat);
+  t0 = PCU_Time();
+  for (int r = 0; r < repeat; ++r)
+    plan.synchronize(fields, 2);
+  report("apf::Exchange::synchronize", PCU_Time() - t0, repeat);
+  compare(m, fields[0], fields[2]);
+  compare(m, fields[1], fields[3]);
+  /* accumulate, once since it is not idempotent */
+  for (int i = 0; i < 4; ++i)
+    setValues(m, fields[i], false);
+  t0 = PCU_Time();
+  apf::accumulate(fields[2]);
+  apf::accumulate(fields[3]);
+  report("apf::accumulate", PCU_Time() - t0, 1);
+  t0 = PCU_Time();
+  plan.accumulate(fields, 2);
+  report("apf::Exchange::accumulate", PCU_Time() - t0, 1);
+  compare(m, fields[0], fields[2]);
+  compare(m, fields[1], fields[3]);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
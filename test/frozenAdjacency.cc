@@ -0,0 +1,94 @@
+#include <gmi_mesh.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+
+/* measures upward adjacency queries per second on a tetrahedral box,
+   first using the linked lists and then the frozen arrays */
+
+namespace {
+
+struct Result
+{
+  double queries;
+  double seconds;
+  size_t checksum;
+};
+
+Result queryAll(apf::Mesh* m)
+{
+  Result r;
+  r.queries = 0;
+  r.checksum = 0;
+  double t0 = PCU_Time();
+  for (int d = 0; d < m->getDimension(); ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      int n = m->countUpward(e);
+      for (int i = 0; i < n; ++i)
+        r.checksum += reinterpret_cast<size_t>(m->getUpward(e, i));
+      apf::Up up;
+      m->getUp(e, up);
+      apf::Adjacent adj;
+      m->getAdjacent(e, m->getDimension(), adj);
+      r.checksum += up.n + adj.getSize();
+      r.queries += n + 3;
+    }
+    m->end(it);
+  }
+  r.seconds = PCU_Time() - t0;
+  return r;
+}
+
+void report(const char* what, Result const& r)
+{
+  lion_oprint(1, "%s: %.0f queries in %f seconds, %e queries/second\n",
+      what, r.queries, r.seconds, r.queries / r.seconds);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n>\n"
+             "  builds an n x n x n box of 6n^3 tets\n"
+             "  (n = 120 gives about 10M tets)\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == 1);
+  int n = atoi(argv[1]);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+  Result linked = queryAll(m);
+  double t0 = PCU_Time();
+  apf::freezeMdsAdjacencies(m);
+  lion_oprint(1, "adjacencies frozen in %f seconds\n", PCU_Time() - t0);
+  Result frozen = queryAll(m);
+  report("linked lists", linked);
+  report("frozen arrays", frozen);
+  PCU_ALWAYS_ASSERT(linked.checksum == frozen.checksum);
+  /* modification discards the frozen arrays */
+  apf::MeshIterator* it = m->begin(3);
+  m->destroy(m->iterate(it));
+  m->end(it);
+  linked = queryAll(m);
+  apf::freezeMdsAdjacencies(m);
+  frozen = queryAll(m);
+  PCU_ALWAYS_ASSERT(linked.checksum == frozen.checksum);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,168 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <pumi.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+
+/* measures the cost of apf::Mesh::isGhost and isGhosted over all
+   elements of a box split into slabs with one layer of ghosts,
+   compared to finding and reading the ghost tags each time */
+
+namespace {
+
+struct Count
+{
+  long ghosts;
+  long ghosted;
+  double seconds;
+};
+
+Count countWithQueries(apf::Mesh* m, int repeat)
+{
+  Count c;
+  c.ghosts = c.ghosted = 0;
+  double t0 = PCU_Time();
+  for (int r = 0; r < repeat; ++r) {
+    apf::MeshIterator* it = m->begin(m->getDimension());
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      c.ghosts += m->isGhost(e);
+      c.ghosted += m->isGhosted(e);
+    }
+    m->end(it);
+  }
+  c.seconds = PCU_Time() - t0;
+  return c;
+}
+
+Count countWithTags(apf::Mesh* m, int repeat)
+{
+  Count c;
+  c.ghosts = c.ghosted = 0;
+  double t0 = PCU_Time();
+  for (int r = 0; r < repeat; ++r) {
+    apf::MeshIterator* it = m->begin(m->getDimension());
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::MeshTag* t = m->findTag("ghost_tag");
+      c.ghosts += t && m->hasTag(e, t);
+      t = m->findTag("ghosted_tag");
+      c.ghosted += t && m->hasTag(e, t);
+    }
+    m->end(it);
+  }
+  c.seconds = PCU_Time() - t0;
+  return c;
+}
+
+/* reordering replaces the mds_apf, and the new one starts with
+   clear ghost bits, so the checks must follow the tags through it */
+void checkReorder(apf::Mesh2* m)
+{
+  apf::MeshTag* t = m->findTag("ghost_tag");
+  if (!t)
+    t = m->createIntTag("ghost_tag", 1);
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  int i = 0;
+  while ((e = m->iterate(it)))
+    if (i++ % 2)
+      m->setIntTag(e, t, &i);
+  m->end(it);
+  Count tags = countWithTags(m, 1);
+  PCU_ALWAYS_ASSERT(tags.ghosts == (long)(m->count(m->getDimension()) / 2));
+  PCU_ALWAYS_ASSERT(countWithQueries(m, 1).ghosts == tags.ghosts);
+  /* the second mds_apf may land where the first one was */
+  apf::reorderMdsMesh(m);
+  apf::reorderMdsMesh(m);
+  Count queries = countWithQueries(m, 1);
+  PCU_ALWAYS_ASSERT(tags.ghosts == queries.ghosts);
+  PCU_ALWAYS_ASSERT(tags.ghosted == queries.ghosted);
+}
+
+/* apf::synchronize also sends to ghosts, so the neighbor set from
+   apf::declareNeighbors has to include their parts */
+void checkNeighbors(apf::Mesh* m)
+{
+  apf::Field* f = apf::createLagrangeField(m, "x", apf::SCALAR, 1);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    apf::setScalar(f, v, 0, m->isOwned(v) ? x[0] : -1);
+  }
+  m->end(it);
+  apf::declareNeighbors(m);
+  apf::synchronize(f);
+  PCU_Comm_Unset_Neighbors();
+  it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    PCU_ALWAYS_ASSERT(apf::getScalar(f, v, 0) == x[0]);
+  }
+  m->end(it);
+  apf::destroyField(f);
+}
+
+void report(const char* what, Count const& c, int repeat, long elements)
+{
+  double t = PCU_Max_Double(c.seconds);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s: %e checks/second\n", what,
+        2.0 * elements * repeat / t);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  pumi_start();
+  lion_set_verbosity(1);
+  if (argc != 3) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <repeat>\n"
+             "  ghosts a layer of elements on an n x n x n box\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int repeat = atoi(argv[2]);
+  gmi_register_null();
+  apf::Mesh2* m = makeSlabs(n);
+  pumi::instance()->mesh = m;
+  pumi_ghost_createLayer(m, 0, 3, 1, 1);
+  long elements = m->count(3);
+  Count tags = countWithTags(m, repeat);
+  Count queries = countWithQueries(m, repeat);
+  report("tag lookups", tags, repeat, elements);
+  report("isGhost/isGhosted", queries, repeat, elements);
+  PCU_ALWAYS_ASSERT(tags.ghosts == queries.ghosts);
+  PCU_ALWAYS_ASSERT(tags.ghosted == queries.ghosted);
+  if (PCU_Comm_Peers() > 1)
+    PCU_ALWAYS_ASSERT(PCU_Add_Long(queries.ghosts) > 0);
+  pumi_ghost_delete(m);
+  queries = countWithQueries(m, 1);
+  PCU_ALWAYS_ASSERT(!queries.ghosts);
+  PCU_ALWAYS_ASSERT(!queries.ghosted);
+  /* enough layers to reach parts that share nothing with this one */
+  pumi_ghost_createLayer(m, 0, 3, n / PCU_Comm_Peers() + 1, 1);
+  checkNeighbors(m);
+  pumi_ghost_delete(m);
+  pumi_mesh_delete(m);
+  /* pumi keeps tag handles that a reorder would free */
+  m = makeSlabs(n);
+  checkReorder(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  pumi_finalize();
+  MPI_Finalize();
+}
@@ -0,0 +1,109 @@
+#include <gmi_analytic.h>
+#include <PCU.h>
+#include <pcu_util.h>
+#include <lionPrint.h>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+/* evaluates points on the edges and faces of an analytic model with
+   gmi_eval_many, through the analytic implementation and through the
+   per-point fallback, and checks both against gmi_eval */
+
+namespace {
+
+void circle(double const p[2], double x[3], void* u)
+{
+  double r = *static_cast<double*>(u);
+  x[0] = r * cos(2 * M_PI * p[0]);
+  x[1] = r * sin(2 * M_PI * p[0]);
+  x[2] = 0;
+}
+
+void cylinder(double const p[2], double x[3], void* u)
+{
+  double r = *static_cast<double*>(u);
+  x[0] = r * cos(2 * M_PI * p[0]);
+  x[1] = r * sin(2 * M_PI * p[0]);
+  x[2] = p[1];
+}
+
+double radii[4] = {1, 2, 3, 4};
+
+gmi_model* makeModel(std::vector<gmi_ent*>& ents)
+{
+  gmi_model* m = gmi_make_analytic();
+  int periodic[2] = {1, 0};
+  double ranges[2][2] = {{0, 1}, {0, 1}};
+  for (int i = 0; i < 2; ++i)
+    ents.push_back(gmi_add_analytic(m, 1, i, circle, periodic, ranges,
+          &radii[i]));
+  for (int i = 0; i < 2; ++i)
+    ents.push_back(gmi_add_analytic(m, 2, i, cylinder, periodic, ranges,
+          &radii[i + 2]));
+  return m;
+}
+
+/* runs of points on one entity, as when snapping, mixed with
+   points that change entity every time */
+void makePoints(std::vector<gmi_ent*> const& ents, int n,
+    std::vector<gmi_ent*>& e, std::vector<double>& p)
+{
+  e.resize(n);
+  p.resize(n * 2);
+  for (int i = 0; i < n; ++i) {
+    int k = (i < n / 2) ? (i / 7) : i;
+    e[i] = ents[k % ents.size()];
+    p[i * 2 + 0] = double(i) / n;
+    p[i * 2 + 1] = double(n - i) / n;
+  }
+}
+
+void check(gmi_model* m, std::vector<gmi_ent*> const& e,
+    std::vector<double> const& p)
+{
+  int n = e.size();
+  double const (*pp)[2] = reinterpret_cast<double const (*)[2]>(&p[0]);
+  std::vector<double> x(n * 3);
+  gmi_eval_many(m, n, &e[0], pp, reinterpret_cast<double (*)[3]>(&x[0]));
+  for (int i = 0; i < n; ++i) {
+    double y[3];
+    gmi_eval(m, e[i], pp[i], y);
+    for (int j = 0; j < 3; ++j)
+      PCU_ALWAYS_ASSERT(x[i * 3 + j] == y[j]);
+  }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n>\n"
+             "  evaluates n points\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  std::vector<gmi_ent*> ents;
+  gmi_model* m = makeModel(ents);
+  std::vector<gmi_ent*> e;
+  std::vector<double> p;
+  makePoints(ents, n, e, p);
+  PCU_ALWAYS_ASSERT(m->ops->eval_many);
+  check(m, e, p);
+  /* the same model without eval_many takes the fallback */
+  gmi_model_ops const* analytic = m->ops;
+  gmi_model_ops fallback = *analytic;
+  fallback.eval_many = 0;
+  m->ops = &fallback;
+  check(m, e, p);
+  m->ops = analytic;
+  gmi_destroy(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
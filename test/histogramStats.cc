@@ -0,0 +1,148 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <ma.h>
+#include <maStats.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+/* measures the edge lengths and linear qualities of a box split into
+   slabs with the vector and the histogram versions of ma::stats, and
+   checks that the histograms summarize the same values */
+
+namespace {
+
+/* sizes that stretch along x across the box */
+class Stretch : public ma::AnisotropicFunction
+{
+  public:
+    Stretch(ma::Mesh* m):mesh(m) {}
+    void getValue(ma::Entity* v, ma::Matrix& r, ma::Vector& h)
+    {
+      ma::Vector x = ma::getPosition(mesh, v);
+      r = ma::Matrix(1, 0, 0, 0, 1, 0, 0, 0, 1);
+      h = ma::Vector(0.05 + 0.1 * x[0], 0.1, 0.2);
+    }
+  private:
+    ma::Mesh* mesh;
+};
+
+struct Summary
+{
+  double count;
+  double min;
+  double max;
+  double mean;
+};
+
+Summary summarize(std::vector<double> const& v)
+{
+  Summary s;
+  double sum = 0;
+  s.min = DBL_MAX;
+  s.max = -DBL_MAX;
+  for (size_t i = 0; i < v.size(); ++i) {
+    sum += v[i];
+    s.min = std::min(s.min, v[i]);
+    s.max = std::max(s.max, v[i]);
+  }
+  s.count = PCU_Add_Double(v.size());
+  s.min = PCU_Min_Double(s.min);
+  s.max = PCU_Max_Double(s.max);
+  s.mean = PCU_Add_Double(sum) / s.count;
+  return s;
+}
+
+bool close(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-12 * std::max(1.0, std::fabs(b));
+}
+
+void compare(const char* what, ma::Histogram const& h,
+    std::vector<double> const& v)
+{
+  Summary s = summarize(v);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s: count %.0f min %f max %f mean %f\n",
+        what, h.getCount(), h.getMin(), h.getMax(), h.getMean());
+  PCU_ALWAYS_ASSERT(h.getCount() == s.count);
+  PCU_ALWAYS_ASSERT(close(h.getMin(), s.min));
+  PCU_ALWAYS_ASSERT(close(h.getMax(), s.max));
+  PCU_ALWAYS_ASSERT(close(h.getMean(), s.mean));
+  double binned = 0;
+  for (int i = 0; i < h.countBins(); ++i)
+    binned += h.getBinCount(i);
+  PCU_ALWAYS_ASSERT(binned == h.getCount());
+}
+
+/* values far outside the range and non-finite ones */
+void checkOutliers()
+{
+  ma::Histogram h(0, 1, 4);
+  h.add(-1e300);
+  h.add(1e300);
+  h.add(NAN);
+  h.add(INFINITY);
+  h.add(-INFINITY);
+  PCU_ALWAYS_ASSERT(h.getCount() == 2);
+  PCU_ALWAYS_ASSERT(h.getBinCount(0) == 1);
+  PCU_ALWAYS_ASSERT(h.getBinCount(3) == 1);
+}
+
+/* in physical space the vector version measures the shared
+   entities on every part, so the histograms are compared with
+   its metric space values under the identity size field, which
+   are measured on owned entities like the histograms */
+void check(ma::Mesh* m, ma::SizeField* sf, bool inMetric)
+{
+  std::vector<double> el, lq;
+  ma::IdentitySizeField identity(m);
+  ma::stats(m, inMetric ? sf : &identity, el, lq, true);
+  ma::Histogram elh(0, 4, 400);
+  ma::Histogram lqh(0, 1, 100);
+  ma::stats(m, sf, elh, lqh, inMetric);
+  compare(inMetric ? "metric edge lengths" : "physical edge lengths",
+      elh, el);
+  compare(inMetric ? "metric linear qualities" : "physical linear qualities",
+      lqh, lq);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n>\n"
+             "  measures an n x n x n box split into slabs\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  checkOutliers();
+  gmi_register_null();
+  ma::Mesh* m = makeSlabs(n);
+  Stretch f(m);
+  ma::SizeField* sf = ma::makeSizeField(m, &f);
+  check(m, sf, true);
+  check(m, sf, false);
+  /* the closed form edge lengths go through both
+     measure and measureEdges the same way */
+  sf->setClosedFormEdges(true);
+  check(m, sf, true);
+  delete sf;
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,198 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cmath>
+
+/* fills a field kept in apf tags and one kept by MDS entity index
+   with the same values on a box split into slabs, checks that they
+   agree through apf::synchronize, the per-type arrays and migration,
+   and reports the time taken to write and read each */
+
+namespace {
+
+/* sends every element to the next part */
+void rotate(apf::Mesh2* m)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  int to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+  apf::MeshIterator* it = m->begin(3);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    plan->send(e, to);
+  m->end(it);
+  m->migrate(plan);
+}
+
+double getExact(apf::Vector3 const& x, int node, int component)
+{
+  return floor(x[component] * 1000) + node * 10 + component;
+}
+
+/* the owners get exact values and the other copies -1 */
+void setValues(apf::Mesh* m, apf::Field* f)
+{
+  apf::FieldShape* s = apf::getShape(f);
+  apf::Vector3 c;
+  for (int d = 0; d <= 3; ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      int nn = s->countNodesOn(m->getType(e));
+      for (int j = 0; j < nn; ++j) {
+        for (int i = 0; i < 3; ++i)
+          c[i] = m->isOwned(e) ? getExact(x, j, i) : -1;
+        apf::setVector(f, e, j, c);
+      }
+    }
+    m->end(it);
+  }
+}
+
+double checkValues(apf::Mesh* m, apf::Field* f)
+{
+  apf::FieldShape* s = apf::getShape(f);
+  apf::Vector3 c;
+  double sum = 0;
+  for (int d = 0; d <= 3; ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      int nn = s->countNodesOn(m->getType(e));
+      for (int j = 0; j < nn; ++j) {
+        apf::getVector(f, e, j, c);
+        for (int i = 0; i < 3; ++i) {
+          PCU_ALWAYS_ASSERT(c[i] == getExact(x, j, i));
+          sum += c[i];
+        }
+      }
+    }
+    m->end(it);
+  }
+  return sum;
+}
+
+/* the sum of all the values, read one node at a time */
+double readValues(apf::Mesh* m, apf::Field* f)
+{
+  apf::FieldShape* s = apf::getShape(f);
+  apf::Vector3 c;
+  double sum = 0;
+  for (int d = 0; d <= 3; ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      int nn = s->countNodesOn(m->getType(e));
+      for (int j = 0; j < nn; ++j) {
+        apf::getVector(f, e, j, c);
+        sum += c[0] + c[1] + c[2];
+      }
+    }
+    m->end(it);
+  }
+  return sum;
+}
+
+/* the same sum read straight from the per-type arrays */
+double sumArrays(apf::Mesh2* m, apf::Field* f)
+{
+  apf::FieldShape* s = apf::getShape(f);
+  double sum = 0;
+  for (int d = 0; d <= 3; ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      int type = m->getType(e);
+      int n = s->countNodesOn(type) * 3;
+      if (!n)
+        continue;
+      int size;
+      double* a = apf::getMdsFieldArray(f, type, &size);
+      int i = apf::getMdsTypeIndex(e);
+      PCU_ALWAYS_ASSERT(a && i < size);
+      for (int j = 0; j < n; ++j)
+        sum += a[i * n + j];
+    }
+    m->end(it);
+  }
+  return sum;
+}
+
+void report(const char* what, double t)
+{
+  t = PCU_Max_Double(t);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s: %f seconds\n", what, t);
+}
+
+void run(apf::Mesh2* m, apf::Field* f, const char* what, int repeat)
+{
+  double t0 = PCU_Time();
+  for (int r = 0; r < repeat; ++r)
+    setValues(m, f);
+  double t1 = PCU_Time();
+  apf::synchronize(f);
+  double t2 = PCU_Time();
+  double sum = checkValues(m, f);
+  double t3 = PCU_Time();
+  for (int r = 0; r < repeat; ++r)
+    PCU_ALWAYS_ASSERT(readValues(m, f) == sum);
+  double t4 = PCU_Time();
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s\n", what);
+  report("  write", t1 - t0);
+  report("  synchronize", t2 - t1);
+  report("  read", t4 - t3);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 3) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <repeat>\n"
+             "  splits an n x n x n box into slabs\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int repeat = atoi(argv[2]);
+  gmi_register_null();
+  apf::Mesh2* m = makeSlabs(n);
+  apf::Field* tagged = apf::createField(
+      m, "tagged", apf::VECTOR, apf::getLagrange(2));
+  apf::Field* indexed = apf::createMdsField(
+      m, "indexed", apf::VECTOR, 0, apf::getLagrange(2));
+  run(m, tagged, "tag storage", repeat);
+  run(m, indexed, "MDS index storage", repeat);
+  PCU_ALWAYS_ASSERT(checkValues(m, indexed) == sumArrays(m, indexed));
+  rotate(m);
+  double sum = checkValues(m, indexed);
+  PCU_ALWAYS_ASSERT(sum == checkValues(m, tagged));
+  PCU_ALWAYS_ASSERT(sum == sumArrays(m, indexed));
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -189,6 +189,21 @@ void getStats(
   std::vector<double> el, lq;
   ma::stats(m, sf, el, lq, true);
 
+  // summarize all parts without gathering the values
+  ma::Histogram elh(0, 4, 400);
+  ma::Histogram lqh(0, 1, 100);
+  ma::stats(m, sf, elh, lqh, true);
+  if (PCU_Comm_Self() == 0) {
+    printf("edge lengths: count %.0f min %f max %f mean %f"
+        " p5 %f p50 %f p95 %f\n", elh.getCount(), elh.getMin(),
+        elh.getMax(), elh.getMean(), elh.getPercentile(5),
+        elh.getPercentile(50), elh.getPercentile(95));
+    printf("linear qualities: count %.0f min %f max %f mean %f"
+        " p5 %f p50 %f p95 %f\n", lqh.getCount(), lqh.getMin(),
+        lqh.getMax(), lqh.getMean(), lqh.getPercentile(5),
+        lqh.getPercentile(50), lqh.getPercentile(95));
+  }
+
 
   // create field for visualizaition
   apf::Field* f_lq = apf::createField(m, "linear_quality", apf::SCALAR, apf::getConstant(m->getDimension()));
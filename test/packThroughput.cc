@@ -0,0 +1,98 @@
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <vector>
+
+/* measures how many small items per second PCU_Comm_Pack can append
+   to the send buffers of a phase, with items sent to every rank in
+   turn, in runs to one rank at a time, and in batches with
+   PCU_Comm_Pack_Many */
+
+namespace {
+
+enum { batch = 16 };
+
+int peerOf(long i, bool scattered, long items)
+{
+  int peers = PCU_Comm_Peers();
+  if (scattered)
+    return (PCU_Comm_Self() + i) % peers;
+  return (PCU_Comm_Self() + i * peers / items) % peers;
+}
+
+void finish(long items)
+{
+  PCU_Comm_Send();
+  long received = 0;
+  while (PCU_Comm_Receive()) {
+    long x;
+    while (!PCU_Comm_Unpacked()) {
+      PCU_COMM_UNPACK(x);
+      ++received;
+    }
+  }
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(received) == PCU_Add_Long(items));
+}
+
+void report(const char* what, long items, double t)
+{
+  t = PCU_Max_Double(t);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s: %ld items in %f seconds, %e items/second\n",
+        what, items, t, items / t);
+}
+
+void packEach(const char* what, long items, bool scattered)
+{
+  PCU_Comm_Begin();
+  double t0 = PCU_Time();
+  for (long i = 0; i < items; ++i)
+    PCU_COMM_PACK(peerOf(i, scattered, items), i);
+  report(what, items, PCU_Time() - t0);
+  finish(items);
+}
+
+void packMany(const char* what, long items)
+{
+  std::vector<long> values(items);
+  for (long i = 0; i < items; ++i)
+    values[i] = i;
+  void const* data[batch];
+  size_t sizes[batch];
+  for (int j = 0; j < batch; ++j)
+    sizes[j] = sizeof(long);
+  PCU_Comm_Begin();
+  double t0 = PCU_Time();
+  for (long i = 0; i < items; i += batch) {
+    int n = 0;
+    for (; n < batch && i + n < items; ++n)
+      data[n] = &values[i + n];
+    PCU_Comm_Pack_Many(peerOf(i, false, items), n, data, sizes);
+  }
+  report(what, items, PCU_Time() - t0);
+  finish(items);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <items>\n"
+             "  packs <items> longs per rank in each test\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  long items = atol(argv[1]);
+  PCU_Comm_Order(false);
+  packEach("scattered", items, true);
+  packEach("grouped", items, false);
+  packMany("pack_many", items);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
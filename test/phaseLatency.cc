@@ -0,0 +1,128 @@
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <vector>
+
+/* measures the time per PCU communication phase for a halo exchange
+   on a 3D grid of ranks, where each rank talks to its (up to 26)
+   face, edge and corner neighbors with message sizes that scale like
+   those of apf::synchronize on a block partition.
+   The same exchange is timed with the original barrier-based phases,
+   with NBX, and with a declared neighbor set. */
+
+namespace {
+
+struct Grid
+{
+  int dims[3];
+  int coords[3];
+  std::vector<int> peers;
+  std::vector<int> sizes;
+};
+
+int rankOf(Grid const& g, int const c[3])
+{
+  return (c[0] * g.dims[1] + c[1]) * g.dims[2] + c[2];
+}
+
+void makeGrid(Grid& g, int n)
+{
+  for (int i = 0; i < 3; ++i)
+    g.dims[i] = 0;
+  MPI_Dims_create(PCU_Comm_Peers(), 3, g.dims);
+  int self = PCU_Comm_Self();
+  g.coords[2] = self % g.dims[2];
+  g.coords[1] = (self / g.dims[2]) % g.dims[1];
+  g.coords[0] = self / (g.dims[2] * g.dims[1]);
+  PCU_ALWAYS_ASSERT(rankOf(g, g.coords) == self);
+  for (int i = -1; i <= 1; ++i)
+  for (int j = -1; j <= 1; ++j)
+  for (int k = -1; k <= 1; ++k) {
+    int d[3] = {i, j, k};
+    int c[3];
+    int zeros = 0;
+    bool inside = true;
+    for (int l = 0; l < 3; ++l) {
+      c[l] = g.coords[l] + d[l];
+      if (c[l] < 0 || c[l] >= g.dims[l])
+        inside = false;
+      if (!d[l])
+        ++zeros;
+    }
+    if (!inside || zeros == 3)
+      continue;
+    g.peers.push_back(rankOf(g, c));
+    /* n^2 values across a face, n along an edge, one at a corner */
+    int size = 1;
+    for (int l = 0; l < zeros; ++l)
+      size *= n;
+    g.sizes.push_back(size);
+  }
+}
+
+void exchange(Grid const& g, std::vector<double>& values)
+{
+  PCU_Comm_Begin();
+  for (size_t i = 0; i < g.peers.size(); ++i) {
+    values.assign(g.sizes[i], PCU_Comm_Self());
+    PCU_Comm_Pack(g.peers[i], &values[0], values.size() * sizeof(double));
+  }
+  PCU_Comm_Send();
+  size_t received = 0;
+  while (PCU_Comm_Receive()) {
+    double x;
+    while (!PCU_Comm_Unpacked()) {
+      PCU_COMM_UNPACK(x);
+      PCU_ALWAYS_ASSERT(x == PCU_Comm_Sender());
+    }
+    ++received;
+  }
+  PCU_ALWAYS_ASSERT(received == g.peers.size());
+}
+
+void run(const char* what, Grid const& g, int phases)
+{
+  std::vector<double> values;
+  exchange(g, values);
+  PCU_Barrier();
+  double t0 = PCU_Time();
+  for (int i = 0; i < phases; ++i)
+    exchange(g, values);
+  double t = PCU_Max_Double(PCU_Time() - t0);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s: %d phases in %f seconds, %f microseconds/phase\n",
+        what, phases, t, t / phases * 1e6);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 3) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <phases>\n"
+             "  exchanges n^2 doubles per face neighbor\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int phases = atoi(argv[2]);
+  Grid g;
+  makeGrid(g, n);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%d x %d x %d ranks\n", g.dims[0], g.dims[1], g.dims[2]);
+  PCU_Comm_Order(false);
+  PCU_Comm_Nbx(false);
+  run("barrier", g, phases);
+  PCU_Comm_Nbx(true);
+  run("nbx", g, phases);
+  PCU_Comm_Set_Neighbors(g.peers.empty() ? 0 : &g.peers[0], g.peers.size());
+  run("neighbors", g, phases);
+  PCU_Comm_Unset_Neighbors();
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
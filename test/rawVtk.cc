@@ -0,0 +1,154 @@
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfNumbering.h>
+#include <apf.h>
+#include <lionCompress.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+
+/* writes a box with a nodal field, a numbering and an integration
+   point field through apf::writeVtkFiles and apf::writeRawVtkFiles,
+   checks the raw points against the mesh, and reports the size of
+   each output */
+
+namespace {
+
+void addFields(apf::Mesh* m)
+{
+  apf::Field* x = apf::createLagrangeField(m, "x", apf::VECTOR, 1);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 p;
+    m->getPoint(v, 0, p);
+    apf::setVector(x, v, 0, p);
+  }
+  m->end(it);
+  apf::numberOwnedNodes(m, "owned");
+  int d = m->getDimension();
+  apf::Field* size = apf::createField(m, "size", apf::SCALAR,
+      apf::getIPShape(d, 1));
+  it = m->begin(d);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    apf::setScalar(size, e, 0, apf::measure(m, e));
+  m->end(it);
+}
+
+std::string getPiece(const char* prefix)
+{
+  std::stringstream ss;
+  ss << prefix << "/0/" << PCU_Comm_Self() << ".vtu";
+  return ss.str();
+}
+
+long getFileSize(const char* prefix)
+{
+  std::ifstream f(getPiece(prefix).c_str(),
+      std::ios::binary | std::ios::ate);
+  PCU_ALWAYS_ASSERT(f.is_open());
+  return PCU_Add_Long(f.tellg());
+}
+
+/* the points are the first appended array */
+template <class T>
+void checkPoints(apf::Mesh* m, const char* prefix)
+{
+  std::ifstream f(getPiece(prefix).c_str(), std::ios::binary);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  std::string s = ss.str();
+  std::string mark = "<AppendedData encoding=\"raw\">\n_";
+  size_t at = s.find(mark);
+  PCU_ALWAYS_ASSERT(at != std::string::npos);
+  const char* data = s.c_str() + at + mark.size();
+  uint64_t bytes;
+  memcpy(&bytes, data, sizeof(bytes));
+  PCU_ALWAYS_ASSERT(bytes == m->count(0) * 3 * sizeof(T));
+  double sum = 0;
+  for (size_t i = 0; i < m->count(0) * 3; ++i) {
+    T x;
+    memcpy(&x, data + sizeof(bytes) + i * sizeof(T), sizeof(T));
+    sum += x;
+  }
+  double expected = 0;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 p;
+    m->getPoint(v, 0, p);
+    expected += p[0] + p[1] + p[2];
+  }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(std::fabs(sum - expected) < 1e-4 * expected);
+}
+
+void report(const char* what, const char* prefix, double t)
+{
+  long size = getFileSize(prefix);
+  t = PCU_Max_Double(t);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%s: %ld bytes in %f seconds\n", what, size, t);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n>\n"
+             "  writes an n x n x n box\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+  addFields(m);
+  double t0 = PCU_Time();
+  apf::writeVtkFiles("rawVtk_base64", m);
+  double t1 = PCU_Time();
+  apf::writeRawVtkFiles("rawVtk_raw", m);
+  double t2 = PCU_Time();
+  apf::writeRawVtkFiles("rawVtk_float32", m, 0, true);
+  double t3 = PCU_Time();
+  checkPoints<double>(m, "rawVtk_raw");
+  checkPoints<float>(m, "rawVtk_float32");
+  report("base64", "rawVtk_base64", t1 - t0);
+  report("raw", "rawVtk_raw", t2 - t1);
+  report("raw float32", "rawVtk_float32", t3 - t2);
+  PCU_ALWAYS_ASSERT(getFileSize("rawVtk_float32") <
+                    getFileSize("rawVtk_raw"));
+  if (lion::can_compress) {
+    for (int level = 1; level <= 9; level += 4) {
+      std::stringstream ss;
+      ss << "rawVtk_zlib" << level;
+      std::string prefix = ss.str();
+      double t4 = PCU_Time();
+      apf::writeRawVtkFiles(prefix.c_str(), m, level);
+      double t5 = PCU_Time();
+      report(prefix.c_str(), prefix.c_str(), t5 - t4);
+    }
+  } else {
+    PCU_ALWAYS_ASSERT(getFileSize("rawVtk_raw") <
+                      getFileSize("rawVtk_base64"));
+  }
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
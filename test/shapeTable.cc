@@ -0,0 +1,172 @@
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfShapeTable.h>
+#include <apfThreads.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <vector>
+
+/* checks that tabulated shape functions equal the ones evaluated
+   directly, that tables can be looked up from several threads,
+   and reports the time taken to evaluate shape gradients at
+   integration points over a box with and without the tables */
+
+namespace {
+
+const int maxOrder = 6;
+
+std::vector<apf::FieldShape*> getShapes()
+{
+  std::vector<apf::FieldShape*> s;
+  s.push_back(apf::getLagrange(1));
+  s.push_back(apf::getLagrange(2));
+  s.push_back(apf::getLagrange(3));
+  s.push_back(apf::getSerendipity());
+  s.push_back(apf::getHierarchic(2));
+  s.push_back(apf::getConstant(3));
+  return s;
+}
+
+int checkTables(apf::FieldShape* s)
+{
+  int checked = 0;
+  for (int type = apf::Mesh::EDGE; type < apf::Mesh::TYPES; ++type) {
+    apf::EntityShape* es = s->getEntityShape(type);
+    for (int order = 1; order <= maxOrder; ++order) {
+      apf::ShapeTable const* t = apf::getShapeTable(s, type, order);
+      if (!es) {
+        PCU_ALWAYS_ASSERT(!t);
+        continue;
+      }
+      if (!t)
+        continue;
+      PCU_ALWAYS_ASSERT(t->countNodes() == es->countNodes());
+      for (int p = 0; p < t->countPoints(); ++p) {
+        apf::NewArray<double> v;
+        apf::NewArray<apf::Vector3> g;
+        es->getValues(0, 0, t->getPoint(p), v);
+        es->getLocalGradients(0, 0, t->getPoint(p), g);
+        for (int k = 0; k < t->countNodes(); ++k) {
+          PCU_ALWAYS_ASSERT(t->getValues(p)[k] == v[k]);
+          for (int d = 0; d < apf::Mesh::typeDimension[type]; ++d)
+            PCU_ALWAYS_ASSERT(t->getLocalGradients(p)[k][d] == g[k][d]);
+        }
+      }
+      ++checked;
+    }
+  }
+  return checked;
+}
+
+/* every thread looks up every table, which should give
+   the same tables as the serial lookups */
+class LookupLoop : public apf::ParallelLoop
+{
+  public:
+    LookupLoop(std::vector<apf::FieldShape*> const& s):
+      shapes(s),
+      mismatches(0)
+    {
+    }
+    void apply(int i, int)
+    {
+      apf::FieldShape* s = shapes[i % shapes.size()];
+      for (int type = apf::Mesh::EDGE; type < apf::Mesh::TYPES; ++type)
+        for (int order = 1; order <= maxOrder; ++order)
+          if (apf::getShapeTable(s, type, order) !=
+              apf::getShapeTable(s, type, order))
+            __sync_fetch_and_add(&mismatches, 1);
+    }
+    std::vector<apf::FieldShape*> const& shapes;
+    int mismatches;
+};
+
+double sumGrads(apf::Mesh* m, apf::Field* f, int order, bool tabulated)
+{
+  double sum = 0;
+  apf::NewArray<apf::Vector3> g;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    apf::MeshElement* me = apf::createMeshElement(m, e);
+    apf::Element* fe = apf::createElement(f, me);
+    int np = apf::countIntPoints(me, order);
+    for (int p = 0; p < np; ++p) {
+      double dv;
+      if (tabulated) {
+        apf::getShapeGrads(fe, order, p, g);
+        dv = apf::getDV(me, order, p);
+      } else {
+        apf::Vector3 xi;
+        apf::getIntPoint(me, order, p, xi);
+        apf::getShapeGrads(fe, xi, g);
+        dv = apf::getDV(me, xi);
+      }
+      for (int k = 0; k < apf::countNodes(fe); ++k)
+        sum += (g[k][0] + g[k][1] + g[k][2]) * dv;
+    }
+    apf::destroyElement(fe);
+    apf::destroyMeshElement(me);
+  }
+  m->end(it);
+  return sum;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 3) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <threads>\n"
+             "  evaluates shape gradients over an n x n x n box\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int threads = atoi(argv[2]);
+  gmi_register_null();
+  std::vector<apf::FieldShape*> shapes = getShapes();
+  apf::setThreadCount(threads);
+  LookupLoop lookup(shapes);
+  apf::parallelFor(threads * 16, lookup);
+  PCU_ALWAYS_ASSERT(!lookup.mismatches);
+  apf::setThreadCount(1);
+  int checked = 0;
+  for (size_t i = 0; i < shapes.size(); ++i)
+    checked += checkTables(shapes[i]);
+  PCU_ALWAYS_ASSERT(checked);
+  PCU_ALWAYS_ASSERT(!apf::getShapeTable(
+        apf::getHierarchic(3), apf::Mesh::TET, 2));
+  apf::Mesh2* m = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+  apf::changeMeshShape(m, apf::getLagrange(2), true);
+  apf::Field* f = apf::createField(m, "f", apf::SCALAR, apf::getLagrange(2));
+  apf::zeroField(f);
+  const int order = 4;
+  double t0 = PCU_Time();
+  double direct = sumGrads(m, f, order, false);
+  double t1 = PCU_Time();
+  double tabulated = sumGrads(m, f, order, true);
+  double t2 = PCU_Time();
+  PCU_ALWAYS_ASSERT(direct == tabulated);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%d tables checked\n"
+        "gradients at integration points:\n"
+        "  evaluated: %f seconds\n"
+        "  tabulated: %f seconds\n",
+        checked, t1 - t0, t2 - t1);
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
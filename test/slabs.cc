@@ -0,0 +1,33 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apf.h>
+#include <PCU.h>
+#include <algorithm>
+
+apf::Mesh2* makeSlabs(int n)
+{
+  int self = PCU_Comm_Self();
+  apf::Mesh2* m;
+  /* build the whole box on rank zero */
+  PCU_Switch_Comm(MPI_COMM_SELF);
+  if (!self)
+    m = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+  PCU_Switch_Comm(MPI_COMM_WORLD);
+  if (self)
+    m = apf::makeEmptyMdsMesh(gmi_load(".null"), 3, false);
+  apf::Migration* plan = new apf::Migration(m);
+  if (!self) {
+    apf::MeshIterator* it = m->begin(3);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      int to = x[0] * PCU_Comm_Peers();
+      plan->send(e, std::min(to, PCU_Comm_Peers() - 1));
+    }
+    m->end(it);
+  }
+  m->migrate(plan);
+  return m;
+}
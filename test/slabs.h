@@ -0,0 +1,10 @@
+#ifndef TEST_SLABS_H
+#define TEST_SLABS_H
+
+#include <apfMesh2.h>
+
+/* builds an n x n x n box of tetrahedra on rank zero and splits it
+   along x into one slab per rank */
+apf::Mesh2* makeSlabs(int n);
+
+#endif
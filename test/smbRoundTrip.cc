@@ -0,0 +1,102 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+/* writes a box split into slabs as version 6 smb files, loads them,
+   writes the loaded mesh back over the same files while it is still
+   in memory, and checks that neither the loaded mesh nor a second
+   load of the rewritten files differ from the first load */
+
+namespace {
+
+const char* fileName = "smbRoundTrip.smb";
+
+std::vector<double> getCoordinates(apf::Mesh* m)
+{
+  std::vector<double> x;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 p;
+    m->getPoint(v, 0, p);
+    for (int i = 0; i < 3; ++i)
+      x.push_back(p[i]);
+  }
+  m->end(it);
+  return x;
+}
+
+double sum(std::vector<double> const& x)
+{
+  double s = 0;
+  for (size_t i = 0; i < x.size(); ++i)
+    s += x[i];
+  return s;
+}
+
+void checkCounts(apf::Mesh* a, apf::Mesh* b)
+{
+  for (int d = 0; d <= 3; ++d) {
+    PCU_ALWAYS_ASSERT(a->count(d) == b->count(d));
+    PCU_ALWAYS_ASSERT(apf::countOwned(a, d) == apf::countOwned(b, d));
+  }
+}
+
+apf::Mesh2* load()
+{
+  apf::Mesh2* m = apf::loadMdsMesh(gmi_load(".null"), fileName);
+  m->verify();
+  return m;
+}
+
+void destroy(apf::Mesh2* m)
+{
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n>\n"
+             "  writes and reloads an n x n x n box split into slabs\n",
+             argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  gmi_register_null();
+  apf::Mesh2* original = makeSlabs(n);
+  original->writeNative(fileName);
+  apf::Mesh2* first = load();
+  checkCounts(original, first);
+  std::vector<double> x = getCoordinates(first);
+  double s = sum(getCoordinates(original));
+  PCU_ALWAYS_ASSERT(std::fabs(sum(x) - s) <= 1e-12 * std::fabs(s));
+  destroy(original);
+  /* the loaded mesh must not depend on the files it came from */
+  first->writeNative(fileName);
+  PCU_ALWAYS_ASSERT(getCoordinates(first) == x);
+  first->verify();
+  apf::Mesh2* second = load();
+  checkCounts(first, second);
+  PCU_ALWAYS_ASSERT(getCoordinates(second) == x);
+  destroy(second);
+  destroy(first);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
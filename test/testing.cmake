@@ -35,6 +35,29 @@ mpi_test(qr_test 1 ./qr)
 mpi_test(base64 1 ./base64)
 mpi_test(tensor_test 1 ./tensor)
 mpi_test(verify_convert 1 ./verify_convert)
+mpi_test(frozenAdjacency 1 ./frozenAdjacency 8)
+mpi_test(smbRoundTrip 4 ./smbRoundTrip 8)
+mpi_test(collectiveMesh_write 2
+  ./collectiveMesh 8 collectiveMesh.smb write)
+mpi_test(collectiveMesh_load 4
+  ./collectiveMesh 8 collectiveMesh.smb load)
+mpi_test(phaseLatency 4 ./phaseLatency 16 100)
+mpi_test(packThroughput 4 ./packThroughput 1000000)
+mpi_test(fieldExchange 4 ./fieldExchange 12 10)
+mpi_test(ghostCheck 4 ./ghostCheck 12 10)
+mpi_test(collapseThreads 1 ./collapseThreads 12 4)
+mpi_test(adaptProfile 2 ./adaptProfile 4)
+mpi_test(transferThroughput 1 ./transferThroughput 8 12)
+mpi_test(gmiEvalMany 1 ./gmiEvalMany 1000)
+mpi_test(histogramStats 4 ./histogramStats 8)
+mpi_test(mdsField 4 ./mdsField 12 10)
+mpi_test(batchIntegrate 1 ./batchIntegrate 12 10)
+mpi_test(shapeTable 1 ./shapeTable 8 4)
+mpi_test(rawVtk 1 ./rawVtk 8)
+if(APF_VTKHDF)
+  mpi_test(vtkHdf 4 ./vtkHdf 8)
+  mpi_test(vtkHdf_emptyParts 8 ./vtkHdf 1)
+endif()
 mpi_test(test_integrator 1
          ./test_integrator
          "${MESHES}/cube/cube.dmg"
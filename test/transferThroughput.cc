@@ -0,0 +1,185 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfShape.h>
+#include <gmi_null.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+/* uniformly refines a box carrying many linear and quadratic fields,
+   once with a transfer object per field and once with the automatic
+   transfer that groups fields by shape, and reports the degrees of
+   freedom each transfers per second spent transferring */
+
+namespace {
+
+/* a linear function, which both shapes reproduce exactly */
+double getExact(int field, int component, apf::Vector3 const& x)
+{
+  return (field + 1) + (component + 1) * x[0] - field * x[1] + 0.5 * x[2];
+}
+
+void setFields(apf::Mesh* m, std::vector<apf::Field*>& fields)
+{
+  for (size_t i = 0; i < fields.size(); ++i) {
+    apf::Field* f = fields[i];
+    int nc = apf::countComponents(f);
+    std::vector<double> c(nc);
+    for (int d = 0; d <= 1; ++d) {
+      if (!apf::getShape(f)->hasNodesIn(d))
+        continue;
+      apf::MeshIterator* it = m->begin(d);
+      apf::MeshEntity* e;
+      while ((e = m->iterate(it))) {
+        apf::Vector3 x = apf::getLinearCentroid(m, e);
+        for (int j = 0; j < nc; ++j)
+          c[j] = getExact(i, j, x);
+        apf::setComponents(f, e, 0, &c[0]);
+      }
+      m->end(it);
+    }
+  }
+}
+
+void checkFields(apf::Mesh* m, std::vector<apf::Field*>& fields)
+{
+  for (size_t i = 0; i < fields.size(); ++i) {
+    apf::Field* f = fields[i];
+    int nc = apf::countComponents(f);
+    std::vector<double> c(nc);
+    for (int d = 0; d <= 1; ++d) {
+      if (!apf::getShape(f)->hasNodesIn(d))
+        continue;
+      apf::MeshIterator* it = m->begin(d);
+      apf::MeshEntity* e;
+      while ((e = m->iterate(it))) {
+        apf::Vector3 x = apf::getLinearCentroid(m, e);
+        apf::getComponents(f, e, 0, &c[0]);
+        for (int j = 0; j < nc; ++j)
+          PCU_ALWAYS_ASSERT(std::fabs(c[j] - getExact(i, j, x)) < 1e-10);
+      }
+      m->end(it);
+    }
+  }
+}
+
+/* forwards to another transfer and adds up the time spent in it */
+class TimedTransfer : public ma::SolutionTransfer
+{
+  public:
+    TimedTransfer(ma::SolutionTransfer* t):
+      transfer(t),
+      time(0)
+    {
+    }
+    virtual bool hasNodesOn(int dimension)
+    {
+      return transfer->hasNodesOn(dimension);
+    }
+    virtual void onVertex(
+        apf::MeshElement* parent,
+        ma::Vector const& xi,
+        ma::Entity* vert)
+    {
+      double t0 = PCU_Time();
+      transfer->onVertex(parent, xi, vert);
+      time += PCU_Time() - t0;
+    }
+    virtual void onRefine(
+        ma::Entity* parent,
+        ma::EntityArray& newEntities)
+    {
+      double t0 = PCU_Time();
+      transfer->onRefine(parent, newEntities);
+      time += PCU_Time() - t0;
+    }
+    virtual void onCavity(
+        ma::EntityArray& oldElements,
+        ma::EntityArray& newEntities)
+    {
+      double t0 = PCU_Time();
+      transfer->onCavity(oldElements, newEntities);
+      time += PCU_Time() - t0;
+    }
+    ma::SolutionTransfer* transfer;
+    double time;
+};
+
+long countDofs(apf::Mesh* m, std::vector<apf::Field*>& fields)
+{
+  long dofs = 0;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    apf::FieldShape* s = apf::getShape(fields[i]);
+    long nodes = 0;
+    for (int d = 0; d <= m->getDimension(); ++d)
+      nodes += m->count(d) * s->countNodesOn(apf::Mesh::simplexTypes[d]);
+    dofs += nodes * apf::countComponents(fields[i]);
+  }
+  return dofs;
+}
+
+void refineBox(const char* what, int n, int nfields, bool grouped)
+{
+  apf::Mesh2* m = apf::makeMdsBox(n, n, n, 1, 1, 1, true);
+  std::vector<apf::Field*> fields;
+  for (int i = 0; i < nfields; ++i) {
+    char name[16];
+    snprintf(name, sizeof(name), "f%d", i);
+    int type = i % 2 ? apf::SCALAR : apf::VECTOR;
+    int order = i % 4 == 3 ? 2 : 1;
+    fields.push_back(apf::createField(m, name, type, apf::getLagrange(order)));
+  }
+  setFields(m, fields);
+  ma::SolutionTransfer* st;
+  if (grouped)
+    st = new ma::AutoSolutionTransfer(m);
+  else {
+    ma::SolutionTransfers* each = new ma::SolutionTransfers();
+    for (int i = 0; i < nfields; ++i)
+      each->add(ma::createFieldTransfer(fields[i]));
+    st = each;
+  }
+  TimedTransfer timed(st);
+  long before = countDofs(m, fields);
+  double t0 = PCU_Time();
+  ma::runUniformRefinement(m, 1, &timed);
+  double t = PCU_Time() - t0;
+  long dofs = countDofs(m, fields) - before;
+  lion_oprint(1, "%s: %ld dofs in %f seconds of transfer"
+      " (%f seconds of refinement), %e dofs/second\n",
+      what, dofs, timed.time, t, dofs / timed.time);
+  checkFields(m, fields);
+  delete st;
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 3 || PCU_Comm_Peers() != 1) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n> <fields>\n"
+             "  refines an n x n x n box with that many fields on one rank\n",
+             argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  int nfields = atoi(argv[2]);
+  gmi_register_null();
+  refineBox("per field", n, nfields, false);
+  refineBox("grouped by shape", n, nfields, true);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,128 @@
+#include "slabs.h"
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <hdf5.h>
+#include <cstdlib>
+#include <vector>
+
+/* writes a box split into slabs with a nodal field through
+   apf::writeVtkHdfFiles, reads the file back on rank zero to check
+   the per-piece counts, offsets and part ids, and reports the time
+   taken next to apf::writeVtkFiles */
+
+namespace {
+
+void addField(apf::Mesh* m)
+{
+  apf::Field* x = apf::createLagrangeField(m, "x", apf::VECTOR, 1);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 p;
+    m->getPoint(v, 0, p);
+    apf::setVector(x, v, 0, p);
+  }
+  m->end(it);
+}
+
+std::vector<long> readLongs(hid_t file, const char* path)
+{
+  hid_t set = H5Dopen2(file, path, H5P_DEFAULT);
+  PCU_ALWAYS_ASSERT(set >= 0);
+  hid_t space = H5Dget_space(set);
+  std::vector<long> values(H5Sget_simple_extent_npoints(space));
+  PCU_ALWAYS_ASSERT(H5Dread(set, H5T_NATIVE_LONG, H5S_ALL, H5S_ALL,
+        H5P_DEFAULT, &values[0]) >= 0);
+  H5Sclose(space);
+  H5Dclose(set);
+  return values;
+}
+
+void check(apf::Mesh* m, const char* fileName)
+{
+  long points = m->count(0);
+  long cells = m->count(3);
+  std::vector<long> allPoints(PCU_Comm_Peers());
+  std::vector<long> allCells(PCU_Comm_Peers());
+  MPI_Gather(&points, 1, MPI_LONG, &allPoints[0], 1, MPI_LONG, 0,
+      PCU_Get_Comm());
+  MPI_Gather(&cells, 1, MPI_LONG, &allCells[0], 1, MPI_LONG, 0,
+      PCU_Get_Comm());
+  if (PCU_Comm_Self())
+    return;
+  hid_t file = H5Fopen(fileName, H5F_ACC_RDONLY, H5P_DEFAULT);
+  PCU_ALWAYS_ASSERT(file >= 0);
+  PCU_ALWAYS_ASSERT(H5Aexists_by_name(file, "/VTKHDF", "Version",
+        H5P_DEFAULT) > 0);
+  PCU_ALWAYS_ASSERT(H5Aexists_by_name(file, "/VTKHDF", "Type",
+        H5P_DEFAULT) > 0);
+  PCU_ALWAYS_ASSERT(readLongs(file, "/VTKHDF/NumberOfPoints") == allPoints);
+  PCU_ALWAYS_ASSERT(readLongs(file, "/VTKHDF/NumberOfCells") == allCells);
+  std::vector<long> ids =
+    readLongs(file, "/VTKHDF/NumberOfConnectivityIds");
+  std::vector<long> offsets = readLongs(file, "/VTKHDF/Offsets");
+  std::vector<long> parts = readLongs(file, "/VTKHDF/CellData/apf_part");
+  std::vector<long> connectivity = readLongs(file, "/VTKHDF/Connectivity");
+  std::vector<long> x = readLongs(file, "/VTKHDF/PointData/x");
+  PCU_ALWAYS_ASSERT(x.size() == readLongs(file, "/VTKHDF/Points").size());
+  size_t offset = 0;
+  size_t cell = 0;
+  size_t id = 0;
+  for (int i = 0; i < PCU_Comm_Peers(); ++i) {
+    /* each piece has one offset more than its cells, from zero */
+    PCU_ALWAYS_ASSERT(offsets[offset] == 0);
+    PCU_ALWAYS_ASSERT(offsets[offset + allCells[i]] == ids[i]);
+    PCU_ALWAYS_ASSERT(ids[i] == 4 * allCells[i]);
+    for (long j = 0; j < allCells[i]; ++j)
+      PCU_ALWAYS_ASSERT(parts[cell + j] == i);
+    for (long j = 0; j < ids[i]; ++j)
+      PCU_ALWAYS_ASSERT(connectivity[id + j] < allPoints[i]);
+    offset += allCells[i] + 1;
+    cell += allCells[i];
+    id += ids[i];
+  }
+  PCU_ALWAYS_ASSERT(offset == offsets.size());
+  PCU_ALWAYS_ASSERT(cell == parts.size());
+  PCU_ALWAYS_ASSERT(id == connectivity.size());
+  H5Fclose(file);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  if (argc != 2) {
+    if (!PCU_Comm_Self())
+      printf("Usage: %s <n>\n"
+             "  writes an n x n x n box split into slabs\n", argv[0]);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  int n = atoi(argv[1]);
+  gmi_register_null();
+  apf::Mesh2* m = makeSlabs(n);
+  addField(m);
+  double t0 = PCU_Time();
+  apf::writeVtkFiles("vtkHdf_base64", m);
+  double t1 = PCU_Time();
+  apf::writeVtkHdfFiles("vtkHdf", m);
+  double t2 = PCU_Time();
+  check(m, "vtkHdf.vtkhdf");
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "base64 vtu: %f seconds, vtkhdf: %f seconds\n",
+        t1 - t0, t2 - t1);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}